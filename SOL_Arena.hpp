@@ -0,0 +1,126 @@
+#ifndef SOL_ARENA_HPP_INCLUDED
+#define SOL_ARENA_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdlib>
+
+#include <new>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+
+namespace sol {
+
+// Monotonic allocator. Memory is handed out from a chain of growing blocks 
+// and only given back all at once by release() or the destructor.
+class Arena {
+    public:
+        Arena(size_t blockSize = 4096): p_blockSize(blockSize) {}
+        Arena(const Arena&) = delete;
+        ~Arena() {
+            release();
+        }
+
+        Arena& operator=(const Arena&) = delete;
+
+        void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+            size_t pad = (align - (size_t)p_cur % align) % align;
+            if (p_cur == nullptr || size + pad > size_t(p_end - p_cur)) {
+                p_grow(size + align);
+                pad = (align - (size_t)p_cur % align) % align;
+            }
+            void* rtn = p_cur + pad;
+            p_cur += pad + size;
+            return rtn;
+        }
+        void release() {
+            while (p_head != nullptr) {
+                Block* t = p_head->next;
+                free(p_head);
+                p_head = t;
+            }
+            p_cur = p_end = nullptr;
+        }
+
+        size_t blocks() const {
+            size_t rtn = 0;
+            for (Block* i = p_head; i != nullptr; i = i->next)
+                ++rtn;
+            return rtn;
+        }
+
+    private:
+        struct Block {
+            Block* next;
+        };
+
+        size_t p_blockSize;
+        Block* p_head = nullptr;
+        char* p_cur = nullptr;
+        char* p_end = nullptr;
+
+        void p_grow(size_t need) {
+            size_t len = std::max(p_blockSize, need + sizeof(Block));
+            Block* b = (Block*)malloc(len);
+            if (b == nullptr)
+                throw std::bad_alloc();
+            b->next = p_head;
+            p_head = b;
+            p_cur = (char*)(b + 1);
+            p_end = (char*)b + len;
+            if (p_blockSize < (size_t(1) << 20))
+                p_blockSize <<= 1;
+        }
+};
+
+// Allocator of the containers of a Value (see Array and Object): the heap 
+// like std::allocator, or an arena which frees nothing until it is 
+// released. Moving a container keeps its allocator, copying it gives the 
+// copy one of the heap.
+template <class T>
+class ArenaAllocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        ArenaAllocator() = default;
+        explicit ArenaAllocator(Arena* a): p_arena(a) {}
+        template <class U>
+        ArenaAllocator(const ArenaAllocator<U>& t): p_arena(t.arena()) {}
+
+        T* allocate(size_t n) {
+            if (p_arena == nullptr)
+                return std::allocator<T>().allocate(n);
+            return (T*)p_arena->allocate(n * sizeof(T), alignof(T));
+        }
+        void deallocate(T* p, size_t n) {
+            if (p_arena == nullptr)
+                std::allocator<T>().deallocate(p, n);
+        }
+        ArenaAllocator select_on_container_copy_construction() const {
+            return ArenaAllocator();
+        }
+
+        // nullptr for the heap.
+        Arena* arena() const {
+            return p_arena;
+        }
+
+        template <class U>
+        bool operator==(const ArenaAllocator<U>& t) const {
+            return p_arena == t.arena();
+        }
+        template <class U>
+        bool operator!=(const ArenaAllocator<U>& t) const {
+            return p_arena != t.arena();
+        }
+
+    private:
+        Arena* p_arena = nullptr;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,529 @@
+#ifndef SOL_BINARY_HPP_INCLUDED
+#define SOL_BINARY_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <string_view>
+
+#include "SOL_Value.hpp"
+#include "SOL_MappedFile.hpp"
+
+namespace sol {
+
+// Binary form of a Value, loaded without any parsing and readable in place 
+// through BinaryView. After the magic "SOLB" comes the root node, every 
+// node starts with a tag:
+//  'N'                                                      null
+//  'S' length bytes                                         string
+//  'A' count width offset[count] nodes                      array
+//  'O' count width (key, value)[count] order[count] keys nodes  object
+// Counts and lengths are varints, 7 bits a byte from the lowest. Table 
+// entries are width (1, 2 or 4) bytes little endian, the fewest holding 
+// the offsets of their container, which are from the start of its node. 
+// Nodes and keys are stored in the order they are listed and none starts 
+// before the end of the one before. Object members keep the order of the 
+// object, order gives their indexes sorted by key. Keys are stored as 
+// length and bytes.
+class Binary {
+    public:
+        Binary() = delete;
+        Binary(const Binary&) = delete;
+        ~Binary() = delete;
+
+        Binary& operator=(const Binary&) = delete;
+
+        // Returns an empty string if the result would exceed 4 GiB.
+        static std::string encode(const Value& v) {
+            std::vector<Layout> layouts;
+            size_t size = p_measure(v, layouts);
+            if (size > UINT32_MAX - 4)
+                return std::string();
+            std::string rtn("SOLB");
+            rtn.reserve(4 + size);
+            p_encode(rtn, v, layouts);
+            return rtn;
+        }
+        // Returns false if data is not a valid encoding.
+        static bool decode(const char* data, size_t len, Value& v);
+        static bool decode(const std::string& data, Value& v) {
+            return decode(data.data(), data.length(), v);
+        }
+
+    private:
+        friend class BinaryView;
+
+        // Size of the node of a container and width of its table entries.
+        struct Layout {
+            size_t size;
+            size_t width;
+        };
+        // An array or object being measured or encoded, with its members, 
+        // the next element or member, and the index of its layout. Measuring 
+        // adds up the size of its keys and nodes below, encoding keeps where 
+        // its node and table start.
+        struct Frame {
+            const Value* value;
+            std::vector<const Object::value_type*> members;
+            size_t next;
+            size_t layout;
+            size_t keys;
+            size_t nodes;
+            size_t last;
+            size_t start;
+            size_t table;
+        };
+
+        static void p_putVarint(std::string& out, size_t n) {
+            while (n >= 0x80) {
+                out += char(n | 0x80);
+                n >>= 7;
+            }
+            out += char(n);
+        }
+        static size_t p_varintLength(size_t n) {
+            size_t rtn = 1;
+            while (n >= 0x80) {
+                n >>= 7;
+                ++rtn;
+            }
+            return rtn;
+        }
+        // Reads the varint at off into n, returns the offset past it, or 0 
+        // if it is out of bounds or over 32 bits.
+        static size_t p_getVarint(const char* data, size_t len, size_t off, size_t& n) {
+            uint64_t rtn = 0;
+            for (int shift = 0; shift < 35 && off < len; shift += 7) {
+                unsigned char b = data[off++];
+                rtn |= uint64_t(b & 0x7F) << shift;
+                if ((b & 0x80) == 0) {
+                    n = size_t(rtn);
+                    return rtn <= UINT32_MAX ? off : 0;
+                }
+            }
+            return 0;
+        }
+        static void p_set(std::string& out, size_t at, size_t width, size_t n) {
+            for (size_t i = 0; i < width; ++i)
+                out[at + i] = char(n >> (8 * i));
+        }
+        static size_t p_get(const char* p, size_t width) {
+            const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+            size_t rtn = 0;
+            for (size_t i = 0; i < width; ++i)
+                rtn |= size_t(u[i]) << (8 * i);
+            return rtn;
+        }
+
+        static Frame p_frame(const Value* v, size_t layout) {
+            Frame rtn{v, {}, 0, layout, 0, 0, 0, 0, 0};
+            if (v->isObject()) {
+                rtn.members.reserve(v->object().size());
+                for (const auto& i : v->object()) {
+                    rtn.members.push_back(&i);
+                    rtn.keys += p_varintLength(i.first.length()) + i.first.length();
+                }
+            }
+            return rtn;
+        }
+        static size_t p_count(const Frame& f) {
+            return f.value->isArray() ? f.value->array().size() : f.members.size();
+        }
+        // The next element or member of f, nullptr past the last.
+        static const Value* p_next(Frame& f) {
+            if (f.next == p_count(f))
+                return nullptr;
+            if (f.value->isArray())
+                return &f.value->array()[f.next++];
+            return &f.members[f.next++]->second;
+        }
+
+        // Finds the layout of every container of v, in the order they are 
+        // encoded, and returns the size of v. The table of a container is 
+        // as wide as the offset of its last node needs, which depends on 
+        // the size of the nodes below, so this is a pass of its own.
+        static size_t p_measure(const Value& v, std::vector<Layout>& layouts) {
+            std::vector<Frame> stack;
+            size_t rtn = 0;
+            auto add = [&](size_t n) {
+                if (stack.empty())
+                    rtn = n;
+                else {
+                    stack.back().nodes += n;
+                    stack.back().last = n;
+                }
+            };
+            const Value* cur = &v;
+            while (cur != nullptr) {
+                if (cur->isArray() || cur->isObject()) {
+                    layouts.push_back({0, 0});
+                    stack.push_back(p_frame(cur, layouts.size() - 1));
+                }
+                else if (cur->isString()) {
+                    size_t n = cur->view().length();
+                    add(1 + p_varintLength(n) + n);
+                }
+                else 
+                    add(1);
+                cur = nullptr;
+                while (!stack.empty()) {
+                    Frame& f = stack.back();
+                    if ((cur = p_next(f)) != nullptr)
+                        break;
+                    size_t count = p_count(f);
+                    size_t entries = f.value->isArray() ? count : 3 * count;
+                    Layout& l = layouts[f.layout];
+                    for (l.width = 1; ; l.width *= 2) {
+                        l.size = 2 + p_varintLength(count) + entries * l.width + f.keys + f.nodes;
+                        if (l.width == 4 || (l.size - f.last) >> (8 * l.width) == 0)
+                            break;
+                    }
+                    size_t n = l.size;
+                    stack.pop_back();
+                    add(n);
+                }
+            }
+            return rtn;
+        }
+
+        // Encodes v with the layouts measured, with a stack of frames in 
+        // place of recursion.
+        static void p_encode(std::string& out, const Value& v, const std::vector<Layout>& layouts) {
+            std::vector<Frame> stack;
+            size_t layout = 0;
+            const Value* cur = &v;
+            while (cur != nullptr) {
+                switch (cur->type()) {
+                    case (VALUE_NULL):
+                        out += 'N';
+                        break;
+                    case (VALUE_STRING): {
+                        std::string_view s = cur->view();
+                        out += 'S';
+                        p_putVarint(out, s.length());
+                        out.append(s.data(), s.length());
+                        break;
+                    }
+                    case (VALUE_ARRAY):
+                    case (VALUE_OBJECT): {
+                        Frame f = p_frame(cur, layout++);
+                        size_t width = layouts[f.layout].width;
+                        size_t count = p_count(f);
+                        f.start = out.size();
+                        out += cur->isArray() ? 'A' : 'O';
+                        p_putVarint(out, count);
+                        out += char(width);
+                        f.table = out.size();
+                        if (cur->isArray()) {
+                            out.resize(f.table + width * count);
+                            stack.push_back(std::move(f));
+                            break;
+                        }
+                        out.resize(f.table + 3 * width * count);
+                        std::vector<size_t> order(count);
+                        for (size_t i = 0; i < count; ++i)
+                            order[i] = i;
+                        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                            return f.members[a]->first < f.members[b]->first;
+                        });
+                        for (size_t i = 0; i < count; ++i) {
+                            p_set(out, f.table + width * (2 * count + i), width, order[i]);
+                            p_set(out, f.table + width * 2 * i, width, out.size() - f.start);
+                            const std::string& k = f.members[i]->first;
+                            p_putVarint(out, k.length());
+                            out += k;
+                        }
+                        stack.push_back(std::move(f));
+                        break;
+                    }
+                }
+                cur = nullptr;
+                // The next node goes where the offset of the next element 
+                // or member of the innermost container points.
+                while (!stack.empty()) {
+                    Frame& f = stack.back();
+                    size_t at = f.value->isArray() ? f.next : 2 * f.next + 1;
+                    if ((cur = p_next(f)) != nullptr) {
+                        size_t width = layouts[f.layout].width;
+                        p_set(out, f.table + width * at, width, out.size() - f.start);
+                        break;
+                    }
+                    stack.pop_back();
+                }
+            }
+        }
+};
+
+// Read-only view of a node of binary data, every access is checked against 
+// the bounds of the data so a corrupt file only gives invalid views. The 
+// data must outlive the view and every view got from it.
+class BinaryView {
+    public:
+        BinaryView() = default;
+        BinaryView(const char* data, size_t len) {
+            if (len >= 5 && memcmp(data, "SOLB", 4) == 0)
+                *this = BinaryView(data, len, 4);
+        }
+        BinaryView(const std::string& data): BinaryView(data.data(), data.length()) {}
+        BinaryView(std::string&&) = delete;
+
+        bool valid() const {
+            return p_data != nullptr;
+        }
+        bool isNull() const {
+            return p_tag() == 'N';
+        }
+        bool isArray() const {
+            return p_tag() == 'A';
+        }
+        bool isObject() const {
+            return p_tag() == 'O';
+        }
+        bool isString() const {
+            return p_tag() == 'S';
+        }
+        // Key of an object member.
+        std::string_view key() const {
+            return p_key;
+        }
+
+        // Count of the elements or members of a container, 0 otherwise.
+        size_t size() const {
+            if (!isArray() && !isObject())
+                return 0;
+            return p_count;
+        }
+        // Element t of an array, or member t (in the order of the object) 
+        // of an object.
+        BinaryView at(size_t t) const {
+            if (isArray() && t < p_count)
+                return p_child(p_entry(t));
+            if (isObject() && t < p_count)
+                return p_member(t);
+            return BinaryView();
+        }
+        // Binary search of the members in key order.
+        BinaryView findField(std::string_view k) const {
+            if (!isObject())
+                return BinaryView();
+            size_t lo = 0, hi = p_count;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                size_t i = p_entry(2 * p_count + mid);
+                BinaryView m = i < p_count ? p_member(i) : BinaryView();
+                if (!m.valid())
+                    return BinaryView();
+                if (m.p_key == k)
+                    return m;
+                if (m.p_key < k)
+                    lo = mid + 1;
+                else 
+                    hi = mid;
+            }
+            return BinaryView();
+        }
+        BinaryView operator[](std::string_view k) const {
+            return findField(k);
+        }
+        BinaryView operator[](size_t t) const {
+            return at(t);
+        }
+
+        // Text of a string, empty otherwise.
+        std::string_view view() const {
+            if (!isString())
+                return std::string_view();
+            return std::string_view(p_data + p_body, p_count);
+        }
+        std::string getString() const {
+            return std::string(view());
+        }
+
+        // Decodes the node and everything below it, returns false (leaving 
+        // v alone) if any of it is corrupt. Nodes are decoded from a stack 
+        // of the views still to decode and where they go, in place of 
+        // recursion. They come in the order they are stored, so a node or 
+        // key starting before the end of the one decoded last is corrupt:
+        // nothing is decoded twice, and the work is bounded by the size of 
+        // the data.
+        bool toValue(Value& v) const {
+            Value rtn;
+            size_t end = p_off;
+            std::vector<std::pair<BinaryView, Value*>> stack{{*this, &rtn}};
+            while (!stack.empty()) {
+                BinaryView n = stack.back().first;
+                Value& t = *stack.back().second;
+                stack.pop_back();
+                if (!n.valid() || n.p_off < end)
+                    return false;
+                end = n.p_end();
+                switch (n.p_tag()) {
+                    case ('N'):
+                        t = Value();
+                        break;
+                    case ('S'):
+                        t = String(n.view());
+                        break;
+                    case ('A'): {
+                        t = Array(n.size());
+                        Array& a = t.array();
+                        for (size_t i = a.size(); i-- > 0;)
+                            stack.emplace_back(n.at(i), &a[i]);
+                        break;
+                    }
+                    case ('O'): {
+                        // Members are pushed backwards, so that they are 
+                        // decoded in order and the last of equal keys wins.
+                        Object o;
+                        o.reserve(n.size());
+                        size_t base = stack.size();
+                        for (size_t i = 0; i < n.size(); ++i) {
+                            BinaryView m = n.p_member(i);
+                            if (!m.valid() || n.p_off + n.p_entry(2 * i) < end)
+                                return false;
+                            end = size_t(m.p_key.data() - p_data) + m.p_key.length();
+                            stack.emplace_back(m, &o[std::string(m.p_key)]);
+                        }
+                        std::reverse(stack.begin() + base, stack.end());
+                        // Moving the object keeps its members in place.
+                        t = std::move(o);
+                        break;
+                    }
+                    default:
+                        return false;
+                }
+            }
+            v = std::move(rtn);
+            return true;
+        }
+
+    private:
+        const char* p_data = nullptr;
+        size_t p_len = 0;
+        size_t p_off = 0;
+        // Where the bytes of a string or the table of a container start, 
+        // the length or count, and the width of the table entries.
+        size_t p_body = 0;
+        size_t p_count = 0;
+        size_t p_width = 0;
+        std::string_view p_key;
+
+    private:
+        // Node at off, invalid unless its tag, length or count and table 
+        // fit.
+        BinaryView(const char* data, size_t len, size_t off) {
+            if (off >= len)
+                return;
+            size_t n = 0;
+            size_t width = 0;
+            size_t body = Binary::p_getVarint(data, len, off + 1, n);
+            switch (data[off]) {
+                case ('N'):
+                    body = off + 1;
+                    n = 0;
+                    break;
+                case ('S'):
+                    if (body == 0 || len - body < n)
+                        return;
+                    break;
+                case ('A'):
+                case ('O'):
+                    if (body == 0 || body == len)
+                        return;
+                    width = (unsigned char)data[body++];
+                    if (width != 1 && width != 2 && width != 4)
+                        return;
+                    if ((len - body) / width / (data[off] == 'A' ? 1 : 3) < n)
+                        return;
+                    break;
+                default:
+                    return;
+            }
+            p_data = data;
+            p_len = len;
+            p_off = off;
+            p_body = body;
+            p_count = n;
+            p_width = width;
+        }
+
+        char p_tag() const {
+            return valid() ? p_data[p_off] : 0;
+        }
+        // Entry i of the table of a container.
+        size_t p_entry(size_t i) const {
+            return Binary::p_get(p_data + p_body + p_width * i, p_width);
+        }
+        // End of the node itself, before its keys and the nodes below.
+        size_t p_end() const {
+            if (isString())
+                return p_body + p_count;
+            return p_body + p_width * (isObject() ? 3 * p_count : p_count);
+        }
+        // Child nodes and keys have to lie behind their parent, so corrupt 
+        // data cannot make a cycle.
+        BinaryView p_child(size_t off) const {
+            if (off == 0)
+                return BinaryView();
+            return BinaryView(p_data, p_len, p_off + off);
+        }
+        BinaryView p_member(size_t t) const {
+            size_t k = p_entry(2 * t);
+            if (k == 0)
+                return BinaryView();
+            std::string_view key = p_string(p_off + k);
+            if (key.data() == nullptr)
+                return BinaryView();
+            BinaryView rtn = p_child(p_entry(2 * t + 1));
+            rtn.p_key = key;
+            return rtn;
+        }
+        // Length prefixed string at off, a null view if it is out of bounds.
+        std::string_view p_string(size_t off) const {
+            size_t n = 0;
+            size_t at = Binary::p_getVarint(p_data, p_len, off, n);
+            if (at == 0 || p_len - at < n)
+                return std::string_view();
+            return std::string_view(p_data + at, n);
+        }
+};
+
+inline bool Binary::decode(const char* data, size_t len, Value& v) {
+    BinaryView root(data, len);
+    Value rtn;
+    if (!root.valid() || !root.toValue(rtn))
+        return false;
+    v = std::move(rtn);
+    return true;
+}
+
+// Binary data of a file, mapped into memory where possible so opening it 
+// costs nothing until its nodes are read.
+class BinaryFile {
+    public:
+        BinaryFile(const std::string& path): p_file(path) {}
+        BinaryFile(const BinaryFile&) = delete;
+        ~BinaryFile() = default;
+
+        BinaryFile& operator=(const BinaryFile&) = delete;
+
+        bool available() const {
+            return p_file.available();
+        }
+        // Invalid if the file could not be read or is not binary SOL.
+        BinaryView root() const {
+            if (!available())
+                return BinaryView();
+            return BinaryView(p_file.data(), p_file.size());
+        }
+
+    private:
+        internal::MappedFile p_file;
+};
+
+}
+
+#endif
\ No newline at end of file
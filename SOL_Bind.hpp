@@ -0,0 +1,463 @@
+#ifndef SOL_BIND_HPP_INCLUDED
+#define SOL_BIND_HPP_INCLUDED
+
+#include <cctype>
+
+#include <string>
+#include <vector>
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <system_error>
+
+#include "SOL_Sink.hpp"
+#include "SOL_Writer.hpp"
+#include "SOL_Scanner.hpp"
+
+// Binds the listed members of a struct to the members of a SOL object with 
+// the same keys, for sol::read and sol::write. Put it at namespace scope 
+// next to the struct, up to 32 members can be listed:
+//     SOL_FIELDS(Item, name, tags, price)
+#define SOL_FIELDS(T, ...) \
+    template <class F> \
+    inline void solFields(T* o, F&& f) { \
+        SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH(SOL_INTERNAL_FIELD, __VA_ARGS__)) \
+    }
+
+#define SOL_INTERNAL_FIELD(x) f(#x, o->x);
+#define SOL_INTERNAL_EXPAND(x) x
+#define SOL_INTERNAL_CAT(a, b) SOL_INTERNAL_CAT2(a, b)
+#define SOL_INTERNAL_CAT2(a, b) a##b
+#define SOL_INTERNAL_NTH(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, n, ...) n
+#define SOL_INTERNAL_COUNT(...) SOL_INTERNAL_EXPAND(SOL_INTERNAL_NTH(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))
+#define SOL_INTERNAL_EACH(m, ...) \
+    SOL_INTERNAL_EXPAND(SOL_INTERNAL_CAT(SOL_INTERNAL_EACH_, SOL_INTERNAL_COUNT(__VA_ARGS__))(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_1(m, x) m(x)
+#define SOL_INTERNAL_EACH_2(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_1(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_3(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_2(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_4(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_3(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_5(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_4(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_6(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_5(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_7(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_6(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_8(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_7(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_9(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_8(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_10(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_9(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_11(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_10(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_12(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_11(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_13(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_12(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_14(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_13(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_15(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_14(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_16(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_15(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_17(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_16(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_18(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_17(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_19(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_18(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_20(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_19(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_21(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_20(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_22(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_21(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_23(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_22(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_24(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_23(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_25(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_24(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_26(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_25(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_27(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_26(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_28(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_27(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_29(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_28(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_30(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_29(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_31(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_30(m, __VA_ARGS__))
+#define SOL_INTERNAL_EACH_32(m, x, ...) m(x) SOL_INTERNAL_EXPAND(SOL_INTERNAL_EACH_31(m, __VA_ARGS__))
+
+namespace sol {
+namespace internal {
+
+// Reads SOL text token by token straight into bound types, it follows the 
+// grammar of Reader and reports errors the same way. A value of the wrong 
+// kind for its type is a "Mismatched type" error.
+class BindReader {
+    public:
+        BindReader(const char* begin, const char* end): p_sc(begin, end) {
+            p_sc.next();
+        }
+        BindReader(const BindReader&) = delete;
+        ~BindReader() = default;
+
+        BindReader& operator=(const BindReader&) = delete;
+
+        const std::string& error() const {
+            return p_error;
+        }
+        bool isArray() const {
+            return p_sc.type() == TOKEN_LSBRACKET;
+        }
+        bool isObject() const {
+            return p_sc.type() == TOKEN_LCBRACKET;
+        }
+        // Passes over an empty array or object, anything in it is a 
+        // mismatch.
+        bool getEmpty() {
+            TokenType close = isObject() ? TOKEN_RCBRACKET : TOKEN_RSBRACKET;
+            if (p_sc.next() != close)
+                return p_fail("Mismatched type@");
+            return true;
+        }
+
+        bool getString(std::string& s) {
+            if (p_sc.type() != TOKEN_VALUE)
+                return mismatch();
+            std::string_view t = p_sc.text();
+            if (!p_sc.escaped())
+                s.assign(t.data(), t.length());
+            else {
+                s.clear();
+                Scanner::unescape(t.data(), t.data() + t.length(), s);
+            }
+            return true;
+        }
+        // Reads a value as an integer or a real, leading spaces and a '+' 
+        // are skipped as Value does, anything else is an error.
+        template <class T>
+        bool getNumber(T& n) {
+            if (p_sc.type() != TOKEN_VALUE)
+                return mismatch();
+            std::string_view s = p_sc.text();
+            if (p_sc.escaped()) {
+                p_scratch.clear();
+                Scanner::unescape(s.data(), s.data() + s.length(), p_scratch);
+                s = p_scratch;
+            }
+            const char* b = s.data();
+            const char* e = b + s.length();
+            while (b < e && isspace((unsigned char)*b))
+                ++b;
+            if (e - b > 1 && *b == '+' && b[1] != '-')
+                ++b;
+            std::from_chars_result r = std::from_chars(b, e, n);
+            while (r.ptr < e && isspace((unsigned char)*r.ptr))
+                ++r.ptr;
+            if (r.ec != std::errc() || r.ptr != e)
+                return invalid("Invalid number@");
+            return true;
+        }
+        // Calls f() for each element of an array, with the element as the 
+        // current value.
+        template <class F>
+        bool getArray(F f) {
+            if (!isArray())
+                return mismatch();
+            p_sc.next();
+            while (p_sc.type() != TOKEN_RSBRACKET) {
+                if (!p_isValue())
+                    return p_fail("Invalid array@");
+                if (!f())
+                    return false;
+                if (p_sc.next() == TOKEN_COMMA)
+                    p_sc.next();
+                else if (p_sc.type() != TOKEN_RSBRACKET)
+                    return invalid("Invalid array@");
+            }
+            return true;
+        }
+        // Calls f(key) for each member of an object, with the member as the 
+        // current value.
+        template <class F>
+        bool getObject(F f) {
+            if (!isObject())
+                return mismatch();
+            p_sc.next();
+            while (p_sc.type() != TOKEN_RCBRACKET) {
+                if (p_sc.type() != TOKEN_KEY)
+                    return p_fail("Invalid object@");
+                std::string_view key = p_sc.text();
+                if (p_sc.next() != TOKEN_EQUAL)
+                    return p_fail("Invalid object@");
+                p_sc.next();
+                if (!p_isValue())
+                    return p_fail("Invalid object@");
+                if (!f(key))
+                    return false;
+                if (p_sc.next() == TOKEN_COMMA)
+                    p_sc.next();
+                else if (p_sc.type() != TOKEN_RCBRACKET)
+                    return invalid("Invalid object@");
+            }
+            return true;
+        }
+        // Checks and passes over the current value, with p_stack in place 
+        // of recursion for nested arrays and objects.
+        bool skip() {
+            if (!isArray() && !isObject())
+                return true;
+            p_stack.clear();
+            while (true) {
+                p_stack.push_back(isObject());
+                p_sc.next();
+                while (true) {
+                    bool object = p_stack.back();
+                    if (p_sc.type() == (object ? TOKEN_RCBRACKET : TOKEN_RSBRACKET)) {
+                        p_stack.pop_back();
+                        if (p_stack.empty())
+                            return true;
+                        if (!p_next())
+                            return false;
+                        continue;
+                    }
+                    const char* msg = object ? "Invalid object@" : "Invalid array@";
+                    if (object) {
+                        if (p_sc.type() != TOKEN_KEY)
+                            return p_fail(msg);
+                        if (p_sc.next() != TOKEN_EQUAL)
+                            return p_fail(msg);
+                        p_sc.next();
+                    }
+                    if (!p_isValue())
+                        return p_fail(msg);
+                    if (isArray() || isObject())
+                        break;
+                    if (!p_next())
+                        return false;
+                }
+            }
+        }
+
+        bool invalid(const char* msg) {
+            p_error = std::string(msg) + p_sc.pos();
+            return false;
+        }
+        bool mismatch() {
+            return invalid("Mismatched type@");
+        }
+
+    private:
+        Scanner p_sc;
+        std::string p_error;
+        std::string p_scratch;
+        // Whether each array or object being skipped is an object.
+        std::vector<bool> p_stack;
+
+    private:
+        bool p_isValue() const {
+            TokenType t = p_sc.type();
+            return t == TOKEN_VALUE || t == TOKEN_LSBRACKET || t == TOKEN_LCBRACKET;
+        }
+        // Passes the comma after an element of the innermost array or 
+        // object being skipped, if there is one.
+        bool p_next() {
+            if (p_sc.next() == TOKEN_COMMA)
+                p_sc.next();
+            else if (p_sc.type() != (p_stack.back() ? TOKEN_RCBRACKET : TOKEN_RSBRACKET))
+                return invalid(p_stack.back() ? "Invalid object@" : "Invalid array@");
+            return true;
+        }
+        bool p_fail(const char* msg) {
+            if (p_sc.type() != TOKEN_ERROR)
+                return invalid(msg);
+            p_error = std::string(p_sc.text()) + p_sc.pos();
+            return false;
+        }
+};
+
+// Finds whether SOL_FIELDS was used for T.
+struct AnyField {
+    template <class M>
+    void operator()(const char*, M&) const {}
+};
+template <class T, class = void>
+struct HasFields: std::false_type {};
+template <class T>
+struct HasFields<T, std::void_t<decltype(solFields((T*)nullptr, AnyField()))>>: std::true_type {};
+
+// Empty optionals are left out when written as members.
+template <class T>
+bool isPresent(const T&) {
+    return true;
+}
+template <class T>
+bool isPresent(const std::optional<T>& t) {
+    return t.has_value();
+}
+
+// Whether T is written as an array.
+template <class T>
+struct IsVector: std::false_type {};
+template <class T>
+struct IsVector<std::vector<T>>: std::true_type {};
+
+}
+
+// How a type is read and written by sol::read and sol::write. It can be 
+// specialized for more types with the same two static functions.
+template <class T, class = void>
+struct Bind;
+
+template <>
+struct Bind<std::string> {
+    static bool read(internal::BindReader& r, std::string& t) {
+        return r.getString(t);
+    }
+    static void write(Sink& out, const Writer& w, const std::string& t) {
+        w.writeString(out, t);
+    }
+};
+
+template <>
+struct Bind<bool> {
+    static bool read(internal::BindReader& r, bool& t) {
+        std::string s;
+        if (!r.getString(s))
+            return false;
+        if (s != "true" && s != "false")
+            return r.invalid("Invalid boolean@");
+        t = s == "true";
+        return true;
+    }
+    static void write(Sink& out, const Writer& w, bool t) {
+        w.writeString(out, t ? "true" : "false");
+    }
+};
+
+template <class T>
+struct Bind<T, std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>> {
+    static bool read(internal::BindReader& r, T& t) {
+        return r.getNumber(t);
+    }
+    static void write(Sink& out, const Writer&, T t) {
+        char buf[32];
+        std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), t);
+        out.put('"');
+        out.write(buf, r.ptr - buf);
+        out.put('"');
+    }
+};
+
+// An empty optional in a vector, which cannot be left out without moving 
+// the elements after it, is written as an empty object if T is a vector 
+// and as an empty array otherwise, which no T is read from.
+template <class T>
+struct Bind<std::optional<T>> {
+    static bool read(internal::BindReader& r, std::optional<T>& t) {
+        if (internal::IsVector<T>::value ? r.isObject() : r.isArray()) {
+            t.reset();
+            return r.getEmpty();
+        }
+        return Bind<T>::read(r, t.emplace());
+    }
+    static void write(Sink& out, const Writer& w, const std::optional<T>& t) {
+        if (!t.has_value())
+            out.write(internal::IsVector<T>::value ? "{}" : "[]", 2);
+        else 
+            Bind<T>::write(out, w, *t);
+    }
+};
+
+template <class T>
+struct Bind<std::vector<T>> {
+    static bool read(internal::BindReader& r, std::vector<T>& t) {
+        t.clear();
+        return r.getArray([&]() {
+            t.emplace_back();
+            return Bind<T>::read(r, t.back());
+        });
+    }
+    static void write(Sink& out, const Writer& w, const std::vector<T>& t) {
+        out.put('[');
+        size_t cnt = 0;
+        for (auto& i : t) {
+            if (cnt++)
+                out.put(',');
+            Bind<T>::write(out, w, i);
+        }
+        out.put(']');
+    }
+};
+
+// Keys without a bound member are checked and skipped, members without a 
+// key are left as they are.
+template <class T>
+struct Bind<T, std::enable_if_t<internal::HasFields<T>::value>> {
+    static bool read(internal::BindReader& r, T& t) {
+        return r.getObject([&](std::string_view k) {
+            bool found = false, rtn = true;
+            solFields(&t, [&](const char* name, auto& m) {
+                if (!found && k == name) {
+                    found = true;
+                    rtn = Bind<std::decay_t<decltype(m)>>::read(r, m);
+                }
+            });
+            return found ? rtn : r.skip();
+        });
+    }
+    static void write(Sink& out, const Writer& w, const T& t) {
+        out.put('{');
+        size_t cnt = 0;
+        solFields(const_cast<T*>(&t), [&](const char* name, auto& m) {
+            if (!internal::isPresent(m))
+                return;
+            if (cnt++)
+                out.put(',');
+            out.write(name, std::char_traits<char>::length(name));
+            out.put('=');
+            Bind<std::decay_t<decltype(m)>>::write(out, w, m);
+        });
+        out.put('}');
+    }
+};
+
+namespace internal {
+
+template <class T>
+bool bindRead(const char* begin, const char* end, T& t, std::string* error, const char* msg) {
+    BindReader r(begin, end);
+    if (!r.isArray() && !r.isObject()) {
+        if (error != nullptr)
+            *error = msg;
+        return false;
+    }
+    if (Bind<T>::read(r, t))
+        return true;
+    if (error != nullptr)
+        *error = r.error();
+    return false;
+}
+
+}
+
+// Parses SOL text straight into t, without building any Value. The text 
+// must hold an array or an object that matches T, errors are reported as 
+// Reader does and t may be partly filled then.
+template <class T>
+bool read(const char* buf, size_t len, T& t, std::string* error = nullptr) {
+    return internal::bindRead(buf, buf + len, t, error, "Invalid buffer");
+}
+template <class T>
+bool read(const std::string& str, T& t, std::string* error = nullptr) {
+    return internal::bindRead(str.data(), str.data() + str.length(), t, error, "Invalid string");
+}
+// Returns a value-initialized T on errors.
+template <class T>
+T read(const char* buf, size_t len) {
+    T rtn{};
+    if (!read(buf, len, rtn))
+        rtn = T{};
+    return rtn;
+}
+template <class T>
+T read(const std::string& str) {
+    return read<T>(str.data(), str.length());
+}
+
+// Writes t as compact SOL text, escaped the way w is set up to.
+template <class T>
+bool write(Sink& out, const T& t, const Writer& w = Writer()) {
+    Bind<T>::write(out, w, t);
+    return out.flush();
+}
+template <class T>
+std::string write(const T& t, const Writer& w = Writer()) {
+    std::string rtn;
+    StringSink out(rtn);
+    write(out, t, w);
+    return rtn;
+}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,313 @@
+#ifndef SOL_BUILDER_HPP_INCLUDED
+#define SOL_BUILDER_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <string_view>
+
+#include "SOL_Arena.hpp"
+#include "SOL_Value.hpp"
+#include "SOL_Stats.hpp"
+#include "SOL_Scanner.hpp"
+
+namespace sol {
+
+// Handler which builds the parsed document as a Value. The containers 
+// being filled are kept on an explicit stack, which is reused by the 
+// following documents, and so are the strings of the pending keys. When 
+// recycling, the storage of the previous result is reused as well.
+class Builder {
+    public:
+        Builder() = default;
+        Builder(const Builder&) = delete;
+        ~Builder() = default;
+
+        Builder& operator=(const Builder&) = delete;
+
+        // See Reader::arena() and Reader::borrow().
+        void arena(Arena* a) {
+            p_arena = a;
+        }
+        void borrow(bool b) {
+            p_borrow = b;
+        }
+        // See Reader::recycle().
+        void recycle(bool b) {
+            p_recycling = b;
+            if (b)
+                return;
+            p_arrays = std::vector<Value>();
+            p_objects = std::vector<Value>();
+            p_strings = std::vector<String>();
+            p_pending = std::vector<Value>();
+#ifndef SOL_FLAT_OBJECT
+            p_nodes = std::vector<Object::node_type>();
+#endif
+        }
+#ifdef SOL_ENABLE_STATS
+        // See Reader::stats().
+        void stats(Stats* s) {
+            p_stats = s;
+        }
+#endif
+
+        // The document, complete once the outermost container has ended.
+        Value& result() {
+            return p_result;
+        }
+        const Value& result() const {
+            return p_result;
+        }
+        void clear() {
+            p_keyCount = 0;
+            if (!p_recycling) {
+                p_stack.clear();
+                p_result = Value();
+                return;
+            }
+            for (Value& v: p_stack)
+                p_keep(v);
+            p_stack.clear();
+            // What p_keep() leaves, shared or in an arena, is let go here.
+            p_keep(p_result);
+            p_result = Value();
+            p_recycle();
+        }
+
+        bool onBeginArray() {
+            if (p_arena != nullptr)
+                p_stack.emplace_back(Array(), *p_arena);
+            else if (p_arrays.empty())
+                p_stack.emplace_back(Array());
+            else {
+                p_stack.push_back(std::move(p_arrays.back()));
+                p_arrays.pop_back();
+            }
+            return true;
+        }
+        bool onEndArray() {
+            return p_end();
+        }
+        bool onBeginObject() {
+            if (p_arena != nullptr)
+                p_stack.emplace_back(Object(), *p_arena);
+            else if (!p_objects.empty()) {
+                p_stack.push_back(std::move(p_objects.back()));
+                p_objects.pop_back();
+            }
+            else {
+                p_stack.emplace_back(Object());
+#ifdef SOL_ENABLE_STATS
+                if (p_stats != nullptr)
+                    ++p_stats->allocations;
+#endif
+            }
+            return true;
+        }
+        bool onKey(std::string_view k) {
+            if (p_keyCount == p_keys.size())
+                p_keys.emplace_back(k);
+            else 
+                p_keys[p_keyCount].assign(k.data(), k.length());
+            ++p_keyCount;
+            return true;
+        }
+        bool onEndObject() {
+            return p_end();
+        }
+        bool onValue(std::string_view v) {
+            if (p_arena != nullptr)
+                return p_add(Value::p_inArena(v, *p_arena));
+            if (p_long(v.length()) && !p_strings.empty()) {
+                String s(p_spareString());
+                s.assign(v.data(), v.length());
+                return p_add(Value(std::move(s)));
+            }
+#ifdef SOL_ENABLE_STATS
+            if (p_stats != nullptr)
+                p_stats->allocations += p_long(v.length());
+#endif
+            return p_add(Value(String(v)));
+        }
+        bool onRawValue(std::string_view v, bool escaped) {
+            if (!escaped)
+                return p_borrow ? p_add(Value::borrow(v.data(), v.length())) : onValue(v);
+            if (p_arena != nullptr) {
+                p_scratch.clear();
+                internal::Scanner::unescape(v.data(), v.data() + v.length(), p_scratch);
+                return onValue(p_scratch);
+            }
+            bool spare = p_long(v.length()) && !p_strings.empty();
+            String s(spare ? p_spareString() : String());
+            internal::Scanner::unescape(v.data(), v.data() + v.length(), s);
+#ifdef SOL_ENABLE_STATS
+            if (p_stats != nullptr && !spare)
+                p_stats->allocations += p_long(s.length());
+#endif
+            return p_add(Value(std::move(s)));
+        }
+
+    private:
+        Arena* p_arena = nullptr;
+        bool p_borrow = false;
+        bool p_recycling = false;
+        std::vector<Value> p_stack;
+        // Only the first p_keyCount are pending, the others keep their 
+        // buffers for the next keys.
+        std::vector<std::string> p_keys;
+        size_t p_keyCount = 0;
+        // Decoded values, before they are copied into an arena.
+        std::string p_scratch;
+        Value p_result;
+        // Storage taken from the previous results: empty arrays and objects, 
+        // long strings (keys of flat objects included) and the nodes of hash 
+        // maps, which keep their keys' buffers. p_pending holds what is left 
+        // to take apart.
+        std::vector<Value> p_arrays;
+        std::vector<Value> p_objects;
+        std::vector<String> p_strings;
+#ifndef SOL_FLAT_OBJECT
+        std::vector<Object::node_type> p_nodes;
+#endif
+        std::vector<Value> p_pending;
+#ifdef SOL_ENABLE_STATS
+        Stats* p_stats = nullptr;
+
+        // Counts the value being added and the allocations its insertion 
+        // makes.
+        void p_count() {
+            ++p_stats->nodes;
+            if (p_stack.empty())
+                return;
+            const Value& c = p_stack.back();
+            size_t key = c.isObject() && p_long(p_keys[p_keyCount - 1].length());
+            // In an arena, only long keys come from the heap.
+            if (p_arena != nullptr)
+                p_stats->allocations += key;
+            else if (c.isArray())
+                p_stats->allocations += c.array().size() == c.array().capacity();
+            else {
+#ifdef SOL_FLAT_OBJECT
+                p_stats->allocations += (key && p_strings.empty()) + (c.object().size() == c.object().capacity());
+#else
+                if (p_nodes.empty())
+                    p_stats->allocations += 1 + key;
+#endif
+            }
+        }
+#endif
+
+        // Whether a string of n characters does not fit in its own buffer.
+        static bool p_long(size_t n) {
+            static const size_t small = String().capacity();
+            return n > small;
+        }
+        String p_spareString() {
+            String rtn(std::move(p_strings.back()));
+            p_strings.pop_back();
+            rtn.clear();
+            return rtn;
+        }
+        // Queues v to be taken apart by the next clear() if it holds any 
+        // storage worth keeping. Shared values and containers in an arena 
+        // are left to be freed.
+        void p_keep(Value& v) {
+            if (v.p_shared || v.p_inArena())
+                return;
+            if (v.p_type == VALUE_ARRAY || v.p_type == VALUE_OBJECT || (v.p_type == VALUE_STRING && v.p_kind == Value::KIND_TEXT && p_long(v.p_string.capacity())))
+                p_pending.push_back(std::move(v));
+        }
+        // Takes the pending values apart, without recursion.
+        void p_recycle() {
+            while (!p_pending.empty()) {
+                Value v(std::move(p_pending.back()));
+                p_pending.pop_back();
+                switch (v.p_type) {
+                    case (VALUE_ARRAY):
+                        for (Value& e: v.p_array)
+                            p_keep(e);
+                        v.p_array.clear();
+                        p_arrays.push_back(std::move(v));
+                        break;
+                    case (VALUE_OBJECT): {
+                        Object& o = *v.p_object;
+#ifdef SOL_FLAT_OBJECT
+                        for (auto& i: o) {
+                            p_keep(i.second);
+                            if (p_long(i.first.capacity()))
+                                p_strings.push_back(std::move(i.first));
+                        }
+                        o.clear();
+#else
+                        while (!o.empty()) {
+                            p_nodes.push_back(o.extract(o.begin()));
+                            p_keep(p_nodes.back().mapped());
+                        }
+#endif
+                        p_objects.push_back(std::move(v));
+                        break;
+                    }
+                    default:
+                        p_strings.push_back(std::move(v.p_string));
+                        break;
+                }
+            }
+        }
+
+        bool p_add(Value&& v) {
+#ifdef SOL_ENABLE_STATS
+            if (p_stats != nullptr)
+                p_count();
+#endif
+            if (p_stack.empty())
+                p_result = std::forward<Value>(v);
+            else if (p_stack.back().isArray())
+                p_stack.back().array().emplace_back(std::forward<Value>(v));
+            else {
+                const std::string& k = p_keys[--p_keyCount];
+#ifndef SOL_FLAT_OBJECT
+                // Nodes kept from the heap cannot go to an object of the 
+                // arena.
+                if (!p_nodes.empty() && p_arena == nullptr) {
+                    Object::node_type n(std::move(p_nodes.back()));
+                    p_nodes.pop_back();
+                    n.key() = k;
+                    n.mapped() = std::forward<Value>(v);
+                    auto r = p_stack.back().object().insert(std::move(n));
+                    // The last of duplicate keys wins.
+                    if (!r.inserted) {
+                        p_keep(r.position->second);
+                        r.position->second = std::move(r.node.mapped());
+                        p_nodes.push_back(std::move(r.node));
+                    }
+                    return true;
+                }
+#endif
+#ifdef SOL_FLAT_OBJECT
+                if (p_long(k.length()) && !p_strings.empty()) {
+                    String s(p_spareString());
+                    s.assign(k);
+                    p_set(p_stack.back().object().emplace(std::move(s), Value()).first->second, std::forward<Value>(v));
+                    return true;
+                }
+#endif
+                p_set(p_stack.back().object()[k], std::forward<Value>(v));
+            }
+            return true;
+        }
+        // Sets a member, keeping what a duplicate key had.
+        void p_set(Value& m, Value&& v) {
+            if (p_recycling)
+                p_keep(m);
+            m = std::forward<Value>(v);
+        }
+        bool p_end() {
+            Value v(std::move(p_stack.back()));
+            p_stack.pop_back();
+            return p_add(std::move(v));
+        }
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,181 @@
+#ifndef SOL_CURSOR_HPP_INCLUDED
+#define SOL_CURSOR_HPP_INCLUDED
+
+#include <string>
+#include <string_view>
+
+#include "SOL_Simd.hpp"
+#include "SOL_Scanner.hpp"
+
+namespace sol {
+
+// Read-only position of a value in SOL text owned by the caller. Nothing 
+// is parsed until asked for: looking up a field or an element skips the 
+// siblings in front of it by matching brackets, without building values 
+// or decoding strings. Only the parts walked through are checked, an 
+// invalid cursor is returned where they turn out to be malformed.
+class Cursor {
+    public:
+        Cursor() = default;
+        Cursor(const char* buf, size_t len): p_end(buf + len) {
+            p_cur = p_value(p_space(buf));
+        }
+        Cursor(const std::string& str): Cursor(str.data(), str.length()) {}
+        Cursor(std::string&&) = delete;
+
+        bool valid() const {
+            return p_cur != nullptr;
+        }
+        bool isArray() const {
+            return valid() && *p_cur == '[';
+        }
+        bool isObject() const {
+            return valid() && *p_cur == '{';
+        }
+        bool isString() const {
+            return valid() && *p_cur == '"';
+        }
+
+        // Key of a cursor got from an object, empty otherwise.
+        std::string_view key() const {
+            return p_key;
+        }
+        // Source text of the whole value, e.g. to parse it with a Reader.
+        std::string_view text() const {
+            return valid() ? std::string_view(p_cur, p_skip(p_cur) - p_cur) : std::string_view();
+        }
+
+        // First element of an array or first member of an object.
+        Cursor first() const {
+            if (isArray()) {
+                const char* p = p_space(p_cur + 1);
+                return p < p_end && *p == ']' ? Cursor() : p_element(p);
+            }
+            if (isObject()) {
+                const char* p = p_space(p_cur + 1);
+                return p < p_end && *p == '}' ? Cursor() : p_member(p);
+            }
+            return Cursor();
+        }
+        // Following element or member in the same container.
+        Cursor next() const {
+            if (!valid() || p_in == 0)
+                return Cursor();
+            const char* p = p_space(p_skip(p_cur));
+            if (p >= p_end || *p != ',')
+                return Cursor();
+            p = p_space(p + 1);
+            return p_in == '[' ? p_element(p) : p_member(p);
+        }
+
+        // If a key appears more than once the first one is found, while a 
+        // Reader keeps the last.
+        Cursor findField(std::string_view k) const {
+            if (!isObject())
+                return Cursor();
+            for (Cursor i = first(); i.valid(); i = i.next())
+                if (i.key() == k)
+                    return i;
+            return Cursor();
+        }
+        Cursor at(size_t t) const {
+            if (!isArray())
+                return Cursor();
+            Cursor i = first();
+            while (i.valid() && t--)
+                i = i.next();
+            return i;
+        }
+        Cursor operator[](std::string_view k) const {
+            return findField(k);
+        }
+        Cursor operator[](size_t t) const {
+            return at(t);
+        }
+        size_t size() const {
+            size_t rtn = 0;
+            for (Cursor i = first(); i.valid(); i = i.next())
+                ++rtn;
+            return rtn;
+        }
+
+        bool getString(std::string& s) const {
+            if (!isString())
+                return false;
+            const char* e = internal::Scanner::skipBody(p_cur + 1, p_end);
+            if (e >= p_end || *e != '"')
+                return false;
+            s.clear();
+            internal::Scanner::unescape(p_cur + 1, e, s);
+            return true;
+        }
+        std::string getString() const {
+            std::string rtn;
+            getString(rtn);
+            return rtn;
+        }
+
+    private:
+        const char* p_cur = nullptr;
+        const char* p_end = nullptr;
+        char p_in = 0;
+        std::string_view p_key;
+
+        const char* p_space(const char* p) const {
+            while (p < p_end && internal::chars.what[(unsigned char)*p] == internal::CHAR_SPACE)
+                ++p;
+            return p;
+        }
+        const char* p_value(const char* p) const {
+            return p < p_end && (*p == '[' || *p == '{' || *p == '"') ? p : nullptr;
+        }
+        // Returns the end of the value starting at p.
+        const char* p_skip(const char* p) const {
+            if (*p == '"') {
+                p = internal::Scanner::skipBody(p + 1, p_end);
+                return p < p_end ? p + 1 : p_end;
+            }
+            size_t depth = 0;
+            while ((p = internal::findBracketStop(p, p_end)) < p_end) {
+                if (*p == '"') {
+                    p = internal::Scanner::skipBody(p + 1, p_end);
+                    if (p < p_end)
+                        ++p;
+                    continue;
+                }
+                if (*p == '[' || *p == '{')
+                    ++depth;
+                else if (--depth == 0)
+                    return p + 1;
+                ++p;
+            }
+            return p_end;
+        }
+        Cursor p_element(const char* p) const {
+            Cursor rtn;
+            rtn.p_cur = p_value(p);
+            rtn.p_end = p_end;
+            rtn.p_in = '[';
+            return rtn.valid() ? rtn : Cursor();
+        }
+        Cursor p_member(const char* p) const {
+            if (p >= p_end || (internal::chars.what[(unsigned char)*p] & internal::CHAR_CLASS) != internal::TOKEN_KEY)
+                return Cursor();
+            const char* k = p;
+            while (p < p_end && (internal::chars.what[(unsigned char)*p] & internal::CHAR_KEY))
+                ++p;
+            Cursor rtn;
+            rtn.p_key = std::string_view(k, p - k);
+            p = p_space(p);
+            if (p >= p_end || *p != '=')
+                return Cursor();
+            rtn.p_cur = p_value(p_space(p + 1));
+            rtn.p_end = p_end;
+            rtn.p_in = '{';
+            return rtn.valid() ? rtn : Cursor();
+        }
+};
+
+}
+
+#endif
\ No newline at end of file
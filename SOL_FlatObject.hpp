@@ -0,0 +1,180 @@
+#ifndef SOL_FLATOBJECT_HPP_INCLUDED
+#define SOL_FLATOBJECT_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <string_view>
+
+namespace sol {
+
+// Map of string keys kept as one vector of members in insertion order. 
+// Small maps are searched linearly, which beats hashing for a handful of 
+// short keys; above a threshold an open addressing index of member 
+// positions is kept next to the vector. The subset of the std::unordered_map 
+// interface used by SOL is provided. Keys must not be changed through 
+// iterators. As with a vector, adding a member (operator[] with a new key, 
+// emplace()) may move all of them and erase() moves those after it, so 
+// references, pointers and iterators to members do not survive either; 
+// reserve() first to add members while holding on to others. The members 
+// and the index come from A, as with a vector.
+template <class V, class A = std::allocator<V>>
+class FlatObject {
+    public:
+        using key_type = std::string;
+        using mapped_type = V;
+        using value_type = std::pair<std::string, V>;
+        using allocator_type = typename std::allocator_traits<A>::template rebind_alloc<value_type>;
+        using iterator = typename std::vector<value_type, allocator_type>::iterator;
+        using const_iterator = typename std::vector<value_type, allocator_type>::const_iterator;
+
+        // Members up to which no index is kept.
+        static constexpr size_t threshold = 8;
+
+        FlatObject() = default;
+        explicit FlatObject(const allocator_type& a): p_items(a), p_index(a) {}
+        // Moves the members one by one if a is not the allocator of t.
+        FlatObject(FlatObject&& t, const allocator_type& a): p_items(std::move(t.p_items), a), p_index(std::move(t.p_index), a) {}
+
+        allocator_type get_allocator() const {
+            return p_items.get_allocator();
+        }
+
+        iterator begin() {
+            return p_items.begin();
+        }
+        iterator end() {
+            return p_items.end();
+        }
+        const_iterator begin() const {
+            return p_items.begin();
+        }
+        const_iterator end() const {
+            return p_items.end();
+        }
+        size_t size() const {
+            return p_items.size();
+        }
+        bool empty() const {
+            return p_items.empty();
+        }
+        size_t capacity() const {
+            return p_items.capacity();
+        }
+        void reserve(size_t n) {
+            p_items.reserve(n);
+        }
+        void clear() {
+            p_items.clear();
+            p_index.clear();
+        }
+
+        iterator find(std::string_view k) {
+            return p_items.begin() + p_find(k);
+        }
+        const_iterator find(std::string_view k) const {
+            return p_items.begin() + p_find(k);
+        }
+        size_t count(std::string_view k) const {
+            return p_find(k) != p_items.size();
+        }
+
+        V& operator[](const std::string& k) {
+            size_t i = p_find(k);
+            if (i == p_items.size())
+                p_insert(k, V());
+            return p_items[i].second;
+        }
+        V& operator[](std::string&& k) {
+            size_t i = p_find(k);
+            if (i == p_items.size())
+                p_insert(std::move(k), V());
+            return p_items[i].second;
+        }
+        std::pair<iterator, bool> emplace(std::string k, V v) {
+            size_t i = p_find(k);
+            if (i != p_items.size())
+                return {p_items.begin() + i, false};
+            p_insert(std::move(k), std::move(v));
+            return {p_items.begin() + i, true};
+        }
+        // Keeps the order of the other members.
+        size_t erase(std::string_view k) {
+            size_t i = p_find(k);
+            if (i == p_items.size())
+                return 0;
+            p_items.erase(p_items.begin() + i);
+            if (!p_index.empty())
+                p_rehash();
+            return 1;
+        }
+
+    private:
+        std::vector<value_type, allocator_type> p_items;
+        // Slots hold a member position plus one, 0 for none. The load stays 
+        // at 1/2 at most.
+        std::vector<uint32_t, typename std::allocator_traits<A>::template rebind_alloc<uint32_t>> p_index;
+
+    private:
+        static size_t p_hash(std::string_view k) {
+            return std::hash<std::string_view>()(k);
+        }
+        static bool p_equal(const std::string& a, std::string_view b) {
+            return a.size() == b.size() && std::memcmp(a.data(), b.data(), b.size()) == 0;
+        }
+        // Position of k, size() if it is missing.
+        size_t p_find(std::string_view k) const {
+            if (p_index.empty()) {
+                for (size_t i = 0; i < p_items.size(); ++i)
+                    if (p_equal(p_items[i].first, k))
+                        return i;
+                return p_items.size();
+            }
+            size_t mask = p_index.size() - 1;
+            for (size_t h = p_hash(k) & mask; p_index[h] != 0; h = (h + 1) & mask)
+                if (p_equal(p_items[p_index[h] - 1].first, k))
+                    return p_index[h] - 1;
+            return p_items.size();
+        }
+        void p_insert(std::string&& k, V&& v) {
+            if (p_items.capacity() == 0)
+                p_items.reserve(4);
+            p_items.emplace_back(std::move(k), std::move(v));
+            if (p_items.size() <= threshold)
+                return;
+            if (2 * p_items.size() > p_index.size())
+                p_rehash();
+            else 
+                p_place(p_items.size() - 1);
+        }
+        void p_insert(const std::string& k, V&& v) {
+            p_insert(std::string(k), std::move(v));
+        }
+        void p_rehash() {
+            p_index.clear();
+            if (p_items.size() <= threshold)
+                return;
+            size_t n = 1;
+            while (n < 4 * p_items.size())
+                n <<= 1;
+            p_index.resize(n);
+            for (size_t i = 0; i < p_items.size(); ++i)
+                p_place(i);
+        }
+        void p_place(size_t i) {
+            size_t mask = p_index.size() - 1;
+            size_t h = p_hash(p_items[i].first) & mask;
+            while (p_index[h] != 0)
+                h = (h + 1) & mask;
+            p_index[h] = uint32_t(i + 1);
+        }
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef SOL_HANDLER_HPP_INCLUDED
+#define SOL_HANDLER_HPP_INCLUDED
+
+#include <string_view>
+#include <type_traits>
+
+namespace sol {
+
+// Receives the events of a parse, see Reader::fromString(str, h). Every 
+// callback returns false to abort the parse. Any class with the same 
+// member functions can be used as a handler, deriving from this one just 
+// provides the ones you do not care about.
+class Handler {
+    public:
+        virtual ~Handler() = default;
+
+        virtual bool onBeginArray() {
+            return true;
+        }
+        virtual bool onEndArray() {
+            return true;
+        }
+        virtual bool onBeginObject() {
+            return true;
+        }
+        virtual bool onKey(std::string_view) {
+            return true;
+        }
+        virtual bool onEndObject() {
+            return true;
+        }
+        // The text is only valid during the call.
+        virtual bool onValue(std::string_view) {
+            return true;
+        }
+};
+
+namespace internal {
+
+// A handler may define onRawValue(std::string_view raw, bool escaped) to 
+// get the text of values before their escapes are decoded.
+template <class H, class = void>
+struct HasRawValue: std::false_type {};
+template <class H>
+struct HasRawValue<H, std::void_t<decltype(std::declval<H&>().onRawValue(std::string_view(), false))>>: std::true_type {};
+
+}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef SOL_INDEX_HPP_INCLUDED
+#define SOL_INDEX_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstdio>
+
+#include <vector>
+
+#include "SOL_Simd.hpp"
+#include "SOL_Scanner.hpp"
+
+namespace sol {
+namespace internal {
+
+// Offsets of the structural characters ('{', '}', '[', ']', '=', ',' and 
+// the quote opening every value) of a container, found without tokenizing 
+// anything else. Value bodies are skipped the way Scanner reads them.
+class StructuralIndex {
+    public:
+        StructuralIndex() = default;
+        StructuralIndex(const StructuralIndex&) = delete;
+        ~StructuralIndex() = default;
+
+        StructuralIndex& operator=(const StructuralIndex&) = delete;
+
+        // Indexes the container starting at begin up to its closing bracket. 
+        // Returns false if it does not end before end, or holds a string or 
+        // character the Scanner would reject. Brackets are only counted, 
+        // not matched.
+        bool build(const char* begin, const char* end) {
+            p_offsets.clear();
+            if (size_t(end - begin) > UINT32_MAX)
+                return false;
+            size_t depth = 0;
+            const char* p = begin;
+            while ((p = findStructStop(p, end)) < end) {
+                p_offsets.push_back(uint32_t(p - begin));
+                switch ((unsigned char)*p) {
+                    case ('"'):
+                        p = Scanner::skipBody(p + 1, end);
+                        if (p == end || *p != '"')
+                            return false;
+                        break;
+                    case ('{'):
+                    case ('['):
+                        ++depth;
+                        break;
+                    case ('}'):
+                    case (']'):
+                        if (depth == 0)
+                            return false;
+                        if (--depth == 0)
+                            return true;
+                        break;
+                    case (0xFF):
+                        return false;
+                }
+                ++p;
+            }
+            return false;
+        }
+
+        const std::vector<uint32_t>& offsets() const {
+            return p_offsets;
+        }
+
+    private:
+        std::vector<uint32_t> p_offsets;
+};
+
+}
+}
+
+#endif
\ No newline at end of file
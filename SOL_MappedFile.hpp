@@ -0,0 +1,93 @@
+#ifndef SOL_MAPPEDFILE_HPP_INCLUDED
+#define SOL_MAPPEDFILE_HPP_INCLUDED
+
+#include <cstdio>
+
+#include <string>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace sol {
+namespace internal {
+
+// Read-only view of a whole file. Regular files are mapped into memory, 
+// anything that can not be mapped (pipes, platforms without mmap) is read 
+// into an owned buffer instead.
+class MappedFile {
+    public:
+        MappedFile(const std::string& path) {
+#if defined(_WIN32)
+            FILE* fin = fopen(path.c_str(), "rb");
+            if (fin == nullptr)
+                return;
+            p_open = true;
+            char buf[65536];
+            size_t len;
+            while ((len = fread(buf, 1, sizeof(buf), fin)) > 0)
+                p_copy.append(buf, len);
+            fclose(fin);
+            p_data = p_copy.data();
+            p_size = p_copy.length();
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+            p_open = true;
+            struct stat st;
+            if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+                void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    madvise(p, st.st_size, MADV_SEQUENTIAL);
+                    p_map = p;
+                    p_data = (const char*)p;
+                    p_size = st.st_size;
+                    close(fd);
+                    return;
+                }
+            }
+            char buf[65536];
+            ssize_t len;
+            while ((len = ::read(fd, buf, sizeof(buf))) > 0)
+                p_copy.append(buf, len);
+            close(fd);
+            p_data = p_copy.data();
+            p_size = p_copy.length();
+#endif
+        }
+        MappedFile(const MappedFile&) = delete;
+        ~MappedFile() {
+#if !defined(_WIN32)
+            if (p_map != nullptr)
+                munmap(p_map, p_size);
+#endif
+        }
+
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool available() const {
+            return p_open;
+        }
+        const char* data() const {
+            return p_data;
+        }
+        size_t size() const {
+            return p_size;
+        }
+
+    private:
+        bool p_open = false;
+        void* p_map = nullptr;
+        const char* p_data = "";
+        size_t p_size = 0;
+        std::string p_copy;
+};
+
+}
+}
+
+#endif
\ No newline at end of file
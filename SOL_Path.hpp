@@ -0,0 +1,264 @@
+#ifndef SOL_PATH_HPP_INCLUDED
+#define SOL_PATH_HPP_INCLUDED
+
+#include <cctype>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <string_view>
+
+#include "SOL_Value.hpp"
+
+namespace sol {
+
+// Dotted path like "a.b.0.c" split once into its steps: a step of digits 
+// only is an array index, any other an object key.
+class Path {
+    public:
+        Path(std::string_view path) {
+            p_steps.reserve(std::count(path.begin(), path.end(), '.') + 1);
+            size_t b = 0;
+            while (true) {
+                size_t e = path.find('.', b);
+                if (e == path.npos)
+                    e = path.length();
+                if (e == b) {
+                    p_valid = false;
+                    p_steps.clear();
+                    return;
+                }
+                p_steps.emplace_back(path.substr(b, e - b));
+                if (e == path.length())
+                    break;
+                b = e + 1;
+            }
+        }
+        Path(const std::string& path): Path(std::string_view(path)) {}
+        Path(const char* path): Path(std::string_view(path)) {}
+
+        // False if any step is empty, such a path finds nothing.
+        bool valid() const {
+            return p_valid;
+        }
+        size_t size() const {
+            return p_steps.size();
+        }
+
+        // Whether the value at the path has the given type. A missing key 
+        // reads as Null, while a missing index or a step into a value of 
+        // the wrong kind fails. Nothing is inserted into v.
+        bool check(const Value& v, ValueType type) const {
+            if (!p_valid)
+                return false;
+            const Value* cur = &v;
+            for (size_t i = 0; i < p_steps.size(); ++i) {
+                bool missing = false;
+                cur = p_steps[i].find(*cur, missing);
+                if (missing)
+                    return i + 1 == p_steps.size() && type == VALUE_NULL;
+                if (cur == nullptr)
+                    return false;
+            }
+            return cur->type() == type;
+        }
+        // The value at the path, nullptr if there is none.
+        const Value* get(const Value& v) const {
+            if (!p_valid)
+                return nullptr;
+            const Value* cur = &v;
+            for (size_t i = 0; i < p_steps.size() && cur != nullptr; ++i) {
+                bool missing = false;
+                cur = p_steps[i].find(*cur, missing);
+            }
+            return cur;
+        }
+        // Shared arrays and objects on the way are detached, see 
+        // Value::share().
+        Value* get(Value& v) const {
+            if (get(static_cast<const Value&>(v)) == nullptr)
+                return nullptr;
+            Value* cur = &v;
+            for (const Step& i : p_steps)
+                cur = i.index ? &cur->array()[i.pos] : &cur->object().find(i.key)->second;
+            return cur;
+        }
+        // Stores t at the path, creating or converting what is in the way 
+        // like operator[] of Value does. False if the path is invalid or 
+        // has an index too large for size_t.
+        bool set(Value& v, Value t) const {
+            if (!p_valid)
+                return false;
+            for (const Step& i : p_steps)
+                if (i.index && i.pos == size_t(-1))
+                    return false;
+            Value* cur = &v;
+            for (const Step& i : p_steps)
+                cur = i.index ? &(*cur)[i.pos] : &(*cur)[i.key];
+            *cur = std::move(t);
+            return true;
+        }
+
+    private:
+        friend class PathSet;
+        friend class Schema;
+
+        struct Step {
+            std::string key;
+            size_t pos = 0;
+            bool index = true;
+
+            Step(std::string_view k): key(k) {
+                for (char c : key) {
+                    if (!isdigit((unsigned char)c)) {
+                        index = false;
+                        return;
+                    }
+                    // Indexes too large for size_t find nothing.
+                    pos = pos > (size_t(-1) - 9) / 10 ? size_t(-1) : pos * 10 + (c - '0');
+                }
+            }
+            bool operator==(const Step& t) const {
+                return index == t.index && key == t.key;
+            }
+            // The child of v this step leads to, nullptr if there is none, 
+            // missing is set if that is because an object lacks the key.
+            const Value* find(const Value& v, bool& missing) const {
+                if (index) {
+                    if (!v.isArray() || v.array().size() <= pos)
+                        return nullptr;
+                    return &v.array()[pos];
+                }
+                if (!v.isObject())
+                    return nullptr;
+                const Object& o = v.object();
+                auto it = o.find(key);
+                if (it == o.end()) {
+                    missing = true;
+                    return nullptr;
+                }
+                return &it->second;
+            }
+        };
+
+        std::vector<Step> p_steps;
+        bool p_valid = true;
+};
+
+// Many "path:Type" checks merged into a trie of their steps, so the whole 
+// list is checked in a single walk of the value that visits each shared 
+// prefix once.
+class PathSet {
+    public:
+        PathSet() {
+            p_nodes.emplace_back(Path::Step(std::string_view()));
+        }
+        PathSet(const std::vector<std::string>& ls): PathSet() {
+            for (auto& i : ls)
+                add(i);
+        }
+
+        // Adds "path:Type", with Type one of Array, Object, String and Null.
+        void add(std::string_view s) {
+            size_t p = s.find_first_of(':');
+            if (p == s.npos) {
+                p_codes.emplace_back(-1);
+                return;
+            }
+            std::string_view lb = s.substr(p + 1);
+            ValueType t;
+            if (lb == "Array")
+                t = VALUE_ARRAY;
+            else if (lb == "Object")
+                t = VALUE_OBJECT;
+            else if (lb == "String")
+                t = VALUE_STRING;
+            else if (lb == "Null")
+                t = VALUE_NULL;
+            else {
+                p_codes.emplace_back(-2);
+                return;
+            }
+            add(Path(s.substr(0, p)), t);
+        }
+        void add(const Path& path, ValueType type) {
+            size_t id = p_codes.size();
+            p_codes.emplace_back(0);
+            if (!path.valid())
+                return;
+            size_t n = 0;
+            for (const Path::Step& i : path.p_steps) {
+                size_t c = p_nodes[n].child;
+                while (c != 0 && !(p_nodes[c].step == i))
+                    c = p_nodes[c].sibling;
+                if (c == 0) {
+                    c = p_nodes.size();
+                    p_nodes.emplace_back(i);
+                    p_nodes[c].sibling = p_nodes[n].child;
+                    p_nodes[n].child = c;
+                }
+                n = c;
+            }
+            p_checks.push_back({id, type, p_nodes[n].check});
+            p_nodes[n].check = p_checks.size();
+        }
+        size_t size() const {
+            return p_codes.size();
+        }
+
+        // Same result as sol::check(v, ls) for the added entries: per entry 
+        // -1 for a missing type, -2 for an unknown type, 0 for a failed and 
+        // 1 for a passed check, then the count of entries other than 1.
+        std::vector<int> check(const Value& v) const {
+            std::vector<int> rtn(p_codes);
+            p_check(0, &v, rtn);
+            int cnt = 0;
+            for (int i : rtn)
+                if (i != 1)
+                    ++cnt;
+            rtn.emplace_back(cnt);
+            return rtn;
+        }
+
+    private:
+        // Children and checks of a node are linked lists through indexes, 
+        // 0 ends them (node 0 is the root, check i is p_checks[i - 1]).
+        struct Node {
+            Path::Step step;
+            size_t child = 0;
+            size_t sibling = 0;
+            size_t check = 0;
+
+            Node(const Path::Step& s): step(s) {}
+        };
+        struct Check {
+            size_t id;
+            ValueType type;
+            size_t next;
+        };
+
+        std::vector<Node> p_nodes;
+        std::vector<Check> p_checks;
+        std::vector<int> p_codes;
+
+    private:
+        // v is the value at node n, nullptr for a missing key.
+        void p_check(size_t n, const Value* v, std::vector<int>& rtn) const {
+            ValueType t = v == nullptr ? VALUE_NULL : v->type();
+            for (size_t i = p_nodes[n].check; i != 0; i = p_checks[i - 1].next)
+                if (p_checks[i - 1].type == t)
+                    rtn[p_checks[i - 1].id] = 1;
+            if (v == nullptr)
+                return;
+            for (size_t i = p_nodes[n].child; i != 0; i = p_nodes[i].sibling) {
+                bool missing = false;
+                const Value* c = p_nodes[i].step.find(*v, missing);
+                if (c != nullptr || missing)
+                    p_check(i, c, rtn);
+            }
+        }
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,402 @@
+#ifndef SOL_PUSHREADER_HPP_INCLUDED
+#define SOL_PUSHREADER_HPP_INCLUDED
+
+#include <cctype>
+#include <cstdio>
+
+#include <string>
+#include <vector>
+
+#include "SOL_Simd.hpp"
+#include "SOL_Token.hpp"
+#include "SOL_Value.hpp"
+#include "SOL_Scanner.hpp"
+#include "SOL_Builder.hpp"
+
+namespace sol {
+
+// Incremental parser: the text is pushed in chunks of any size by feed() 
+// and ended by finish(), while events go to the handler as soon as they 
+// are complete. Only the token cut by a chunk boundary is kept between 
+// calls, never the text seen so far. Tokens, errors and their positions 
+// are the same as Reader's.
+template <class H>
+class PushParser {
+    public:
+        PushParser(H& h): p_handler(h) {}
+        PushParser(const PushParser&) = delete;
+        ~PushParser() = default;
+
+        PushParser& operator=(const PushParser&) = delete;
+
+        const std::string& error() const {
+            return p_error;
+        }
+        // The outermost container has ended, following input is ignored.
+        bool done() const {
+            return p_state == PARSE_DONE;
+        }
+
+        // See Reader::maxDepth().
+        void maxDepth(size_t n) {
+            p_maxDepth = n;
+        }
+
+        // Start over with a new document.
+        void reset() {
+            p_stack.clear();
+            p_state = PARSE_START;
+            p_lex = LEX_SPACE;
+            p_failed = false;
+            p_line = p_column = 1;
+        }
+
+        // Returns false once the document turned out to be invalid.
+        bool feed(const char* buf, size_t len) {
+            const char* end = buf + len;
+            while (buf < end && !p_failed && !done())
+                buf = p_lexer(buf, end);
+            return !p_failed;
+        }
+        bool feed(const std::string& str) {
+            return feed(str.data(), str.length());
+        }
+        // Returns true if a complete document has been parsed.
+        bool finish() {
+            if (p_failed || done())
+                return !p_failed;
+            switch (p_lex) {
+                case (LEX_SPACE):
+                    break;
+                case (LEX_KEY):
+                    p_lex = LEX_SPACE;
+                    if (!p_token(internal::TOKEN_KEY))
+                        return false;
+                    break;
+                default:
+                    p_lex = LEX_SPACE;
+                    return p_lexError("Incomplete value");
+            }
+            p_tline = p_line;
+            p_tcolumn = p_column;
+            return p_token(internal::TOKEN_EOF) && done();
+        }
+
+    private:
+        using ParseState = enum {
+            PARSE_START,
+            PARSE_DONE,
+            PARSE_ARRAY_VALUE,
+            PARSE_ARRAY_COMMA,
+            PARSE_OBJECT_KEY,
+            PARSE_OBJECT_EQUAL,
+            PARSE_OBJECT_VALUE,
+            PARSE_OBJECT_COMMA
+        };
+        using LexState = enum {
+            LEX_SPACE,
+            LEX_KEY,
+            LEX_BODY,
+            LEX_ESCAPE,
+            LEX_UNICODE
+        };
+
+        H& p_handler;
+        std::string p_error;
+        std::vector<bool> p_stack;
+        size_t p_maxDepth = size_t(-1);
+        ParseState p_state = PARSE_START;
+        LexState p_lex = LEX_SPACE;
+        bool p_failed = false;
+        size_t p_line = 1, p_column = 1;
+        size_t p_tline = 1, p_tcolumn = 1;
+        std::string p_text;
+        unsigned int p_xnum = 0, p_xcnt = 0;
+        char p_xs[4];
+
+    private:
+        std::string p_pos() const {
+            return std::string("Line: ") + std::to_string(p_tline) + " Column: " + std::to_string(p_tcolumn);
+        }
+        bool p_invalid(const char* msg) {
+            p_error = std::string(msg) + p_pos();
+            p_failed = true;
+            return false;
+        }
+        bool p_fail(internal::TokenType t, const char* msg) {
+            if (t != internal::TOKEN_ERROR)
+                return p_invalid(msg);
+            p_error = p_text + p_pos();
+            p_failed = true;
+            return false;
+        }
+        bool p_abort() {
+            return p_invalid("Aborted by handler@");
+        }
+        // Moves the position past c, which may be a line feed ending an 
+        // escape.
+        void p_count(char c) {
+            if (c == '\n') {
+                ++p_line;
+                p_column = 1;
+            }
+            else 
+                ++p_column;
+        }
+        // Error tokens carry their message as text.
+        bool p_lexError(const char* msg) {
+            p_text = msg;
+            return p_token(internal::TOKEN_ERROR);
+        }
+
+        // Consumes characters of [p, end) up to the end of a token at most, 
+        // returns where it stopped.
+        const char* p_lexer(const char* p, const char* end) {
+            switch (p_lex) {
+                case (LEX_SPACE): {
+                    while (p < end && internal::chars.what[(unsigned char)*p] == internal::CHAR_SPACE)
+                        p_count(*p++);
+                    if (p == end)
+                        return p;
+                    p_tline = p_line;
+                    p_tcolumn = p_column;
+                    internal::TokenType t = internal::TokenType(internal::chars.what[(unsigned char)*p] & internal::CHAR_CLASS);
+                    switch (t) {
+                        case (internal::TOKEN_VALUE):
+                            ++p_column;
+                            p_text.clear();
+                            p_lex = LEX_BODY;
+                            return p + 1;
+                        case (internal::TOKEN_KEY):
+                            ++p_column;
+                            p_text.assign(1, *p);
+                            p_lex = LEX_KEY;
+                            return p + 1;
+                        case (internal::TOKEN_EOF):
+                            p_token(internal::TOKEN_EOF);
+                            return p;
+                        case (internal::TOKEN_ERROR):
+                            p_lexError("Invalid key");
+                            return p;
+                        default:
+                            ++p_column;
+                            p_token(t);
+                            return p + 1;
+                    }
+                }
+                case (LEX_KEY): {
+                    const char* q = p;
+                    while (q < end && (internal::chars.what[(unsigned char)*q] & internal::CHAR_KEY))
+                        ++q;
+                    p_text.append(p, q);
+                    p_column += q - p;
+                    if (q < end) {
+                        p_lex = LEX_SPACE;
+                        p_token(internal::TOKEN_KEY);
+                    }
+                    return q;
+                }
+                case (LEX_BODY): {
+                    const char* q = internal::findValueStop(p, end);
+                    p_text.append(p, q);
+                    p_column += q - p;
+                    if (q == end)
+                        return q;
+                    if (*q == '"') {
+                        ++p_column;
+                        p_lex = LEX_SPACE;
+                        p_token(internal::TOKEN_VALUE);
+                    }
+                    else if (*q == '\\') {
+                        ++p_column;
+                        p_lex = LEX_ESCAPE;
+                    }
+                    else if (internal::chars.what[(unsigned char)*q] == internal::TOKEN_EOF)
+                        p_lexError("Incomplete value");
+                    else 
+                        p_lexError("Invalid value character");
+                    return q + 1;
+                }
+                case (LEX_ESCAPE):
+                    p_count(*p);
+                    p_lex = LEX_BODY;
+                    switch (*p) {
+                        case ('t'):
+                            p_text += '\t';
+                            break;
+                        case ('n'):
+                            p_text += '\n';
+                            break;
+                        case ('r'):
+                            p_text += '\r';
+                            break;
+                        case ('"'):
+                            p_text += '"';
+                            break;
+                        case ('\\'):
+                            p_text += '\\';
+                            break;
+                        case ('u'):
+                            p_xnum = p_xcnt = 0;
+                            p_lex = LEX_UNICODE;
+                            break;
+                        default:
+                            p_text += '\\';
+                            p_text += *p;
+                    }
+                    return p + 1;
+                case (LEX_UNICODE):
+                    p_count(*p);
+                    if (!isxdigit((unsigned char)*p)) {
+                        // Like Reader, the character breaking the escape is 
+                        // dropped.
+                        p_text += "\\u";
+                        p_text.append(p_xs, p_xcnt);
+                        p_lex = LEX_BODY;
+                        return p + 1;
+                    }
+                    p_xs[p_xcnt++] = *p;
+                    p_xnum = (p_xnum << 4) + internal::Scanner::x2d(*p);
+                    if (p_xcnt == 4) {
+                        internal::Scanner::utf8(p_xnum, p_text);
+                        p_lex = LEX_BODY;
+                    }
+                    return p + 1;
+            }
+            return p;
+        }
+
+        // Moves the parse state on by one token.
+        bool p_token(internal::TokenType t) {
+            switch (p_state) {
+                case (PARSE_START):
+                    if (t == internal::TOKEN_LSBRACKET || t == internal::TOKEN_LCBRACKET)
+                        return p_element(t, "");
+                    p_error = "Invalid string";
+                    p_failed = true;
+                    return false;
+                case (PARSE_DONE):
+                    return true;
+                case (PARSE_ARRAY_VALUE):
+                    if (t == internal::TOKEN_RSBRACKET)
+                        return p_end();
+                    p_state = PARSE_ARRAY_COMMA;
+                    return p_element(t, "Invalid array@");
+                case (PARSE_ARRAY_COMMA):
+                    if (t == internal::TOKEN_COMMA) {
+                        p_state = PARSE_ARRAY_VALUE;
+                        return true;
+                    }
+                    if (t == internal::TOKEN_RSBRACKET)
+                        return p_end();
+                    return p_invalid("Invalid array@");
+                case (PARSE_OBJECT_KEY):
+                    if (t == internal::TOKEN_RCBRACKET)
+                        return p_end();
+                    if (t != internal::TOKEN_KEY)
+                        return p_fail(t, "Invalid object@");
+                    p_state = PARSE_OBJECT_EQUAL;
+                    return p_handler.onKey(p_text) || p_abort();
+                case (PARSE_OBJECT_EQUAL):
+                    if (t != internal::TOKEN_EQUAL)
+                        return p_fail(t, "Invalid object@");
+                    p_state = PARSE_OBJECT_VALUE;
+                    return true;
+                case (PARSE_OBJECT_VALUE):
+                    p_state = PARSE_OBJECT_COMMA;
+                    return p_element(t, "Invalid object@");
+                case (PARSE_OBJECT_COMMA):
+                    if (t == internal::TOKEN_COMMA) {
+                        p_state = PARSE_OBJECT_KEY;
+                        return true;
+                    }
+                    if (t == internal::TOKEN_RCBRACKET)
+                        return p_end();
+                    return p_invalid("Invalid object@");
+            }
+            return false;
+        }
+        bool p_element(internal::TokenType t, const char* msg) {
+            if ((t == internal::TOKEN_LSBRACKET || t == internal::TOKEN_LCBRACKET) && p_stack.size() >= p_maxDepth)
+                return p_invalid("Too deep@");
+            switch (t) {
+                case (internal::TOKEN_LSBRACKET):
+                    p_stack.push_back(true);
+                    p_state = PARSE_ARRAY_VALUE;
+                    return p_handler.onBeginArray() || p_abort();
+                case (internal::TOKEN_LCBRACKET):
+                    p_stack.push_back(false);
+                    p_state = PARSE_OBJECT_KEY;
+                    return p_handler.onBeginObject() || p_abort();
+                case (internal::TOKEN_VALUE):
+                    return p_handler.onValue(p_text) || p_abort();
+                default:
+                    return p_fail(t, msg);
+            }
+        }
+        bool p_end() {
+            bool array = p_stack.back();
+            p_stack.pop_back();
+            if (p_stack.empty())
+                p_state = PARSE_DONE;
+            else 
+                p_state = p_stack.back() ? PARSE_ARRAY_COMMA : PARSE_OBJECT_COMMA;
+            return (array ? p_handler.onEndArray() : p_handler.onEndObject()) || p_abort();
+        }
+};
+
+// Incremental counterpart of Reader, building the pushed document as a 
+// Value.
+class PushReader {
+    public:
+        PushReader() = default;
+        PushReader(const PushReader&) = delete;
+        ~PushReader() = default;
+
+        PushReader& operator=(const PushReader&) = delete;
+
+        const std::string& error() const {
+            return p_parser.error();
+        }
+        const Value& result() const {
+            return p_builder.result();
+        }
+        // See Reader::takeResult().
+        Value takeResult() {
+            return std::move(p_builder.result());
+        }
+
+        // See Reader::arena().
+        void arena(Arena* a) {
+            p_builder.arena(a);
+        }
+        // See Reader::maxDepth().
+        void maxDepth(size_t n) {
+            p_parser.maxDepth(n);
+        }
+
+        void reset() {
+            p_builder.clear();
+            p_parser.reset();
+        }
+        bool feed(const char* buf, size_t len) {
+            return p_parser.feed(buf, len);
+        }
+        bool feed(const std::string& str) {
+            return p_parser.feed(str);
+        }
+        bool finish() {
+            if (p_parser.finish())
+                return true;
+            p_builder.clear();
+            return false;
+        }
+
+    private:
+        Builder p_builder;
+        PushParser<Builder> p_parser{p_builder};
+};
+
+}
+
+#endif
\ No newline at end of file
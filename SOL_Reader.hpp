@@ -0,0 +1,445 @@
+#ifndef SOL_READER_HPP_INCLUDED
+#define SOL_READER_HPP_INCLUDED
+
+#include <cctype>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "SOL_Arena.hpp"
+#include "SOL_Index.hpp"
+#include "SOL_Stats.hpp"
+#include "SOL_Token.hpp"
+#include "SOL_Value.hpp"
+#include "SOL_Schema.hpp"
+#include "SOL_Scanner.hpp"
+#include "SOL_Builder.hpp"
+#include "SOL_Handler.hpp"
+#include "SOL_MappedFile.hpp"
+
+namespace sol {
+
+// Parses SOL text into a Value, or into the events of a handler. Every 
+// reader keeps its own error and result, so different readers can be used 
+// from different threads at the same time.
+class Reader {
+    public:
+        Reader() = default;
+        Reader(const Reader&) = delete;
+        ~Reader() = default;
+
+        Reader& operator=(const Reader&) = delete;
+
+        const std::string& error() const {
+            return p_error;
+        }
+        const Value& result() const {
+            return p_builder.result();
+        }
+        // Moves the result out of the reader, which is left holding null.
+        Value takeResult() {
+            return std::move(p_builder.result());
+        }
+        // Shares the result in place (see Value::share()) and returns a 
+        // copy of it, which only takes a reference to its nodes.
+        Value shareResult() {
+            return p_builder.result().share();
+        }
+
+        // Build the following results in the arena, nullptr (initially) for 
+        // the heap: their objects, the buffers of their arrays and objects 
+        // and their strings too long for their own buffer. Only keys that 
+        // long still come from the heap. The arena must outlive every such 
+        // result, including the one held by the reader.
+        void arena(Arena* a) {
+            p_arena = a;
+            p_builder.arena(a);
+        }
+        // Leave string values of the following results in the input instead 
+        // of copying them, see Value::borrow(). A string or buffer parsed 
+        // this way must outlive the result, a mapped file is kept by the 
+        // reader until the next parse.
+        void borrow(bool b) {
+            p_borrow = b;
+            p_builder.borrow(b);
+        }
+        // Keep the storage of each result (its arrays, objects, members and 
+        // strings too long for their own buffer) when the next parse 
+        // replaces it, and build the following results out of it: once 
+        // documents of some shape have been parsed, parsing more of them 
+        // makes no allocation. Only a result left in the reader is kept, not 
+        // one taken or shared, nor one in an arena. false (initially) frees 
+        // what is kept.
+        void recycle(bool b) {
+            p_builder.recycle(b);
+        }
+        // Build the elements of a large top-level array on up to n threads, 
+        // 1 (the default) parses on the calling thread only. Not used with 
+        // an arena, which is not thread safe.
+        void threads(size_t n) {
+            p_threads = n;
+        }
+        // Validate the following parses against s while parsing, nullptr 
+        // (initially) for none. A parse stops at the first violation, which 
+        // is reported with its position. The schema must outlive the parses.
+        void schema(const Schema* s) {
+            p_schema = s;
+        }
+        // Fail the following parses at the first array or object nested 
+        // more than n deep, with "Too deep" and its position. There is no 
+        // limit initially: parsing does not recurse, the depth only costs 
+        // memory.
+        void maxDepth(size_t n) {
+            p_maxDepth = n;
+        }
+#ifdef SOL_ENABLE_STATS
+        // Add up what the following parses do in s, nullptr (initially) to 
+        // stop. The nodes and allocations are those of the Value built by 
+        // the reader, handlers only get their tokens counted. Parses are 
+        // made on the calling thread only while it is set, see threads().
+        void stats(Stats* s) {
+            p_stats = s;
+            p_builder.stats(s);
+        }
+#endif
+
+        bool fromFile(const std::string& path) {
+            return p_build([&] {
+                return fromFile(path, p_builder);
+            });
+        }
+        bool fromString(const std::string& str) {
+            return p_build([&] {
+                return fromString(str, p_builder);
+            });
+        }
+        bool fromBuffer(const char* buf, size_t len) {
+            return p_build([&] {
+                return fromBuffer(buf, len, p_builder);
+            });
+        }
+
+        // Drive a handler (see Handler) instead of building a Value.
+        template <class H>
+        bool fromFile(const std::string& path, H& h) {
+            std::unique_ptr<internal::MappedFile> f(new internal::MappedFile(path));
+            if (!f->available()) {
+                p_error = "Fail to open file";
+                return false;
+            }
+            bool rtn = p_parse(f->data(), f->data() + f->size(), h, "Invalid file");
+            if (p_borrow)
+                p_file.swap(f);
+            return rtn;
+        }
+        template <class H>
+        bool fromString(const std::string& str, H& h) {
+            return p_parse(str.data(), str.data() + str.length(), h, "Invalid string");
+        }
+        template <class H>
+        bool fromBuffer(const char* buf, size_t len, H& h) {
+            return p_parse(buf, buf + len, h, "Invalid buffer");
+        }
+
+    private:
+        std::string p_error;
+        std::string p_scratch;
+        Builder p_builder;
+        bool p_borrow = false;
+        Arena* p_arena = nullptr;
+        size_t p_threads = 1;
+        const Schema* p_schema = nullptr;
+        const std::string* p_violation = nullptr;
+        size_t p_maxDepth = size_t(-1);
+        // Whether each open array or object is an object, innermost last.
+        std::vector<bool> p_stack;
+        std::unique_ptr<internal::MappedFile> p_file;
+#ifdef SOL_ENABLE_STATS
+        Stats* p_stats = nullptr;
+#endif
+
+        // Smaller texts are not worth starting threads for.
+        static constexpr size_t p_parallelMin = 1 << 18;
+
+    private:
+        template <class F>
+        bool p_build(F f) {
+            p_builder.clear();
+            if (f())
+                return true;
+            p_builder.clear();
+            return false;
+        }
+
+        template <class H>
+        bool p_parse(const char* begin, const char* end, H& h, const char* msg) {
+            if (p_schema != nullptr) {
+                Validator<H> f(*p_schema, h);
+                p_violation = &f.violation();
+                bool rtn = p_scan(begin, end, f, msg);
+                p_violation = nullptr;
+                return rtn;
+            }
+            if constexpr (std::is_same<H, Builder>::value) {
+                if (&h == &p_builder && p_parallel(begin, end))
+                    return true;
+            }
+            return p_scan(begin, end, h, msg);
+        }
+        template <class H>
+        bool p_scan(const char* begin, const char* end, H& h, const char* msg) {
+            internal::Scanner sc(begin, end);
+#ifdef SOL_ENABLE_STATS
+            if (p_stats != nullptr) {
+                p_scanPass(begin, end);
+                internal::StatsTimer timer(p_stats, &Stats::seconds);
+                sc.stats(p_stats);
+                size_t copies = Value::copies();
+                bool rtn = p_getDocument(sc, h, msg);
+                p_stats->bytes += sc.position() - begin;
+                p_stats->copies += Value::copies() - copies;
+                return rtn;
+            }
+#endif
+            return p_getDocument(sc, h, msg);
+        }
+#ifdef SOL_ENABLE_STATS
+        // Times a pass which only scans the tokens of the text, up to its 
+        // end or first error. Reading the clock around each token would 
+        // cost more than most tokens take to scan.
+        void p_scanPass(const char* begin, const char* end) {
+            internal::StatsTimer timer(p_stats, &Stats::scanSeconds);
+            internal::Scanner sc(begin, end);
+            while (true) {
+                internal::TokenType t = sc.next();
+                if (t == internal::TOKEN_EOF || t == internal::TOKEN_ERROR)
+                    return;
+            }
+        }
+#endif
+        template <class H>
+        bool p_getDocument(internal::Scanner& sc, H& h, const char* msg) {
+            switch (sc.next()) {
+                case (internal::TOKEN_LSBRACKET):
+                case (internal::TOKEN_LCBRACKET):
+                    return p_getTree(sc, h);
+                default:
+                    p_error = msg;
+                    return false;
+            }
+        }
+        // Parses a top-level array on several threads: its structure is 
+        // indexed first, then its elements are cut into one slice per thread 
+        // at top-level commas, each slice is built by its own reader and the 
+        // results are moved into one Array in order. Returns false whenever 
+        // that does not apply or a slice fails, the text is then parsed 
+        // serially, which also reports the error at its position.
+        bool p_parallel(const char* begin, const char* end) {
+            if (p_threads < 2 || p_arena != nullptr || p_maxDepth == 0 || size_t(end - begin) < p_parallelMin)
+                return false;
+#ifdef SOL_ENABLE_STATS
+            if (p_stats != nullptr)
+                return false;
+#endif
+            while (begin < end && internal::chars.what[(unsigned char)*begin] == internal::CHAR_SPACE)
+                ++begin;
+            internal::StructuralIndex index;
+            if (begin == end || *begin != '[' || !index.build(begin, end))
+                return false;
+            // The index does not match brackets, an array closed by '}' is 
+            // left to the serial parse to reject.
+            const std::vector<uint32_t>& offsets = index.offsets();
+            if (begin[offsets.back()] != ']')
+                return false;
+            std::vector<const char*> cuts{begin + 1};
+            std::vector<const char*> ends;
+            size_t depth = 0;
+            size_t step = offsets.back() / p_threads;
+            // A comma right before the closing bracket would leave an empty 
+            // slice, it is never a cut.
+            for (size_t i = 0; i + 2 < offsets.size() && cuts.size() < p_threads; ++i) {
+                const char* p = begin + offsets[i];
+                if (*p == '{' || *p == '[')
+                    ++depth;
+                else if (*p == '}' || *p == ']')
+                    --depth;
+                else if (*p == ',' && depth == 1 && size_t(p - begin) >= step * cuts.size()) {
+                    ends.push_back(p);
+                    cuts.push_back(p + 1);
+                }
+            }
+            ends.push_back(begin + offsets.back());
+            size_t n = cuts.size();
+            if (n < 2)
+                return false;
+
+            std::unique_ptr<Reader[]> readers(new Reader[n]);
+            std::unique_ptr<bool[]> ok(new bool[n]);
+            auto work = [&](size_t k) {
+                try {
+                    readers[k].p_builder.borrow(p_borrow);
+                    readers[k].p_maxDepth = p_maxDepth - 1;
+                    ok[k] = readers[k].p_getElements(cuts[k], ends[k], k + 1 == n);
+                }
+                catch (...) {
+                    ok[k] = false;
+                }
+            };
+            std::vector<std::thread> pool;
+            for (size_t k = 1; k < n; ++k) {
+                try {
+                    pool.emplace_back(work, k);
+                }
+                catch (const std::system_error&) {
+                    work(k);
+                }
+            }
+            work(0);
+            for (std::thread& t: pool)
+                t.join();
+
+            size_t count = 0;
+            for (size_t k = 0; k < n; ++k) {
+                if (!ok[k])
+                    return false;
+                count += readers[k].p_builder.result().array().size();
+            }
+            Array a;
+            a.reserve(count);
+            for (size_t k = 0; k < n; ++k)
+                for (Value& v: readers[k].p_builder.result().array())
+                    a.push_back(std::move(v));
+            p_builder.result() = Value(std::move(a));
+            return true;
+        }
+        // Builds the comma separated elements in [begin, end) as an array, 
+        // last allows a trailing comma.
+        bool p_getElements(const char* begin, const char* end, bool last) {
+            internal::Scanner sc(begin, end);
+            p_builder.onBeginArray();
+            sc.next();
+            while (true) {
+                if (!p_getElement(sc, p_builder, "Invalid array@"))
+                    return false;
+                if (sc.next() == internal::TOKEN_EOF)
+                    break;
+                if (sc.type() != internal::TOKEN_COMMA)
+                    return false;
+                if (sc.next() == internal::TOKEN_EOF) {
+                    if (!last)
+                        return false;
+                    break;
+                }
+            }
+            return p_builder.onEndArray();
+        }
+        bool p_invalid(const internal::Scanner& sc, const char* msg) {
+            p_error = std::string(msg) + sc.pos();
+            return false;
+        }
+        bool p_fail(const internal::Scanner& sc, const char* msg) {
+            if (sc.type() != internal::TOKEN_ERROR)
+                return p_invalid(sc, msg);
+            p_error = std::string(sc.text()) + sc.pos();
+            return false;
+        }
+        bool p_abort(const internal::Scanner& sc) {
+            if (p_violation != nullptr && !p_violation->empty())
+                p_error = *p_violation + "@" + sc.pos();
+            else 
+                p_error = std::string("Aborted by handler@") + sc.pos();
+            return false;
+        }
+
+        template <class H>
+        bool p_onValue(const internal::Scanner& sc, H& h) {
+#ifdef SOL_ENABLE_STATS
+            if (p_stats != nullptr && sc.escaped())
+                ++p_stats->escapes;
+#endif
+            if constexpr (internal::HasRawValue<H>::value)
+                return h.onRawValue(sc.text(), sc.escaped());
+            else {
+                if (!sc.escaped())
+                    return h.onValue(sc.text());
+                p_scratch.clear();
+                internal::Scanner::unescape(sc.text().data(), sc.text().data() + sc.text().length(), p_scratch);
+                return h.onValue(p_scratch);
+            }
+        }
+        template <class H>
+        bool p_getElement(internal::Scanner& sc, H& h, const char* msg) {
+            switch (sc.type()) {
+                case (internal::TOKEN_LSBRACKET):
+                case (internal::TOKEN_LCBRACKET):
+                    return p_getTree(sc, h);
+                case (internal::TOKEN_VALUE):
+                    return p_onValue(sc, h) || p_abort(sc);
+                default:
+                    return p_fail(sc, msg);
+            }
+        }
+        // Parses the array or object starting at the current token, nested 
+        // ones included, with p_stack in place of recursion.
+        template <class H>
+        bool p_getTree(internal::Scanner& sc, H& h) {
+            p_stack.clear();
+            while (true) {
+                if (p_stack.size() >= p_maxDepth)
+                    return p_invalid(sc, "Too deep@");
+                bool object = sc.type() == internal::TOKEN_LCBRACKET;
+                if (!(object ? h.onBeginObject() : h.onBeginArray()))
+                    return p_abort(sc);
+                p_stack.push_back(object);
+                sc.next();
+                while (true) {
+                    object = p_stack.back();
+                    if (sc.type() == (object ? internal::TOKEN_RCBRACKET : internal::TOKEN_RSBRACKET)) {
+                        if (!(object ? h.onEndObject() : h.onEndArray()))
+                            return p_abort(sc);
+                        p_stack.pop_back();
+                        if (p_stack.empty())
+                            return true;
+                        if (!p_next(sc))
+                            return false;
+                        continue;
+                    }
+                    const char* msg = object ? "Invalid object@" : "Invalid array@";
+                    if (object) {
+                        if (sc.type() != internal::TOKEN_KEY)
+                            return p_fail(sc, msg);
+                        if (!h.onKey(sc.text()))
+                            return p_abort(sc);
+                        if (sc.next() != internal::TOKEN_EQUAL)
+                            return p_fail(sc, msg);
+                        sc.next();
+                    }
+                    if (sc.type() == internal::TOKEN_LSBRACKET || sc.type() == internal::TOKEN_LCBRACKET)
+                        break;
+                    if (sc.type() != internal::TOKEN_VALUE)
+                        return p_fail(sc, msg);
+                    if (!p_onValue(sc, h))
+                        return p_abort(sc);
+                    if (!p_next(sc))
+                        return false;
+                }
+            }
+        }
+        // Passes the comma after an element of the innermost array or 
+        // object, if there is one.
+        bool p_next(internal::Scanner& sc) {
+            if (sc.next() == internal::TOKEN_COMMA)
+                sc.next();
+            else if (sc.type() != (p_stack.back() ? internal::TOKEN_RCBRACKET : internal::TOKEN_RSBRACKET))
+                return p_invalid(sc, p_stack.back() ? "Invalid object@" : "Invalid array@");
+            return true;
+        }
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -1,229 +1,298 @@
 #ifndef SOL_SCANNER_HPP_INCLUDED
 #define SOL_SCANNER_HPP_INCLUDED
 
+#include <cstdio>
+#include <cstring>
+
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <string_view>
 
+#include "SOL_Simd.hpp"
+#include "SOL_Stats.hpp"
 #include "SOL_Token.hpp"
 
 namespace sol {
 namespace internal {
 
-using ScanType = enum __ {
-    SCAN_FILE,
-    SCAN_STRING
+// Class of every byte for the scanner: the type of the token it starts 
+// (punctuation, TOKEN_KEY for letters and '_', TOKEN_VALUE for '"', 
+// TOKEN_EOF for 0xFF which reads as the end and TOKEN_ERROR for anything 
+// else) or CHAR_SPACE, and the CHAR_KEY flag for the characters which can 
+// follow the first one of a key. Unlike <cctype>, it does not depend on 
+// the locale.
+enum {
+    CHAR_SPACE = TOKEN_VALUE + 1,
+    CHAR_CLASS = 0x7F,
+    CHAR_KEY = 0x80
+};
+
+struct CharTable {
+    unsigned char what[256];
+
+    constexpr CharTable(): what() {
+        for (int c = 0; c < 256; ++c)
+            what[c] = TOKEN_ERROR;
+        for (int c = 'a'; c <= 'z'; ++c) {
+            what[c] = TOKEN_KEY | CHAR_KEY;
+            what[c - 'a' + 'A'] = TOKEN_KEY | CHAR_KEY;
+        }
+        for (int c = '0'; c <= '9'; ++c)
+            what[c] = TOKEN_ERROR | CHAR_KEY;
+        what['_'] = TOKEN_KEY | CHAR_KEY;
+        what[' '] = what['\t'] = what['\n'] = what['\v'] = what['\f'] = what['\r'] = CHAR_SPACE;
+        what['{'] = TOKEN_LCBRACKET;
+        what['['] = TOKEN_LSBRACKET;
+        what['}'] = TOKEN_RCBRACKET;
+        what[']'] = TOKEN_RSBRACKET;
+        what['='] = TOKEN_EQUAL;
+        what[','] = TOKEN_COMMA;
+        what['"'] = TOKEN_VALUE;
+        what[0xFF] = TOKEN_EOF;
+    }
 };
 
+inline constexpr CharTable chars{};
+
+// Splits SOL text into tokens without building any: the scanner only 
+// keeps the type of the current token, where it starts and the text of a 
+// key, a value (undecoded, between its quotes) or an error. Line and 
+// column are worked out from the start of the token when they are asked 
+// for, which is only done for errors.
 class Scanner {
     public:
-        Scanner(ScanType type, const std::string& str): p_type(type) {
-            if (type == SCAN_FILE)
-                p_fin.open(str);
-            else 
-                p_sin.str(str);
-        }
-        Scanner(ScanType type, std::string&& str): p_type(type) {
-            if (type == SCAN_FILE)
-                p_fin.open(str);
-            else 
-                p_sin.str(str);
-        }
+        Scanner(const char* begin, const char* end): p_begin(begin), p_cur(begin), p_end(end) {}
         Scanner(const Scanner&) = delete;
-        ~Scanner() {
-            if (p_type == SCAN_FILE && p_fin.is_open())
-                p_fin.close();
-        }
+        ~Scanner() = default;
 
         Scanner& operator=(const Scanner&) = delete;
 
-        bool available() const {
-            return p_type == SCAN_FILE ? p_fin.is_open() : true;
+#ifdef SOL_ENABLE_STATS
+        // Count the tokens and the time spent scanning them into s.
+        void stats(Stats* s) {
+            p_stats = s;
         }
-
-        const Token& token() const {
-            return p_token;
+        // Where scanning has got to.
+        const char* position() const {
+            return p_cur;
         }
-        void next() {
-            p_skip();
-            switch (p_peek()) {
-                case (EOF):
-                    p_token = Token();
-                    break;
-                case ('{'):
-                    p_token = Token(TOKEN_LCBRACKET, p_line, p_column, "{");
-                    p_get();
-                    break;
-                case ('['):
-                    p_token = Token(TOKEN_LSBRACKET, p_line, p_column, "[");
-                    p_get();
-                    break;
-                case ('}'):
-                    p_token = Token(TOKEN_RCBRACKET, p_line, p_column, "}");
-                    p_get();
-                    break;
-                case (']'):
-                    p_token = Token(TOKEN_RSBRACKET, p_line, p_column, "]");
-                    p_get();
-                    break;
-                case ('='):
-                    p_token = Token(TOKEN_EQUAL, p_line, p_column, "=");
-                    p_get();
-                    break;
-                case (','):
-                    p_token = Token(TOKEN_COMMA, p_line, p_column, ",");
-                    p_get();
-                    break;
-                case ('"'):
-                    p_token = p_getValue();
-                    p_get();
-                    break;
-                default:
-                    if (isalpha(p_peek()) || p_peek() == '_')
-                        p_token = p_getKey();
-                    else 
-                        p_token = Token(TOKEN_ERROR, p_line, p_column, "Invalid key");
-                    break;
+#endif
+
+        // Decodes the escapes in the body of a value.
+        static void unescape(const char* p, const char* end, std::string& s) {
+            while (true) {
+                const char* q = findValueStop(p, end);
+                s.append(p, q);
+                if (q == end || *q != '\\')
+                    return;
+                p = p_unescape(q + 1, end, s);
             }
         }
+        // Returns where a value body starting at begin ends, that is its 
+        // closing quote if it is valid.
+        static const char* skipBody(const char* begin, const char* end) {
+            bool escaped = false;
+            return p_skipBody(begin, end, escaped);
+        }
 
-    private:
-        Token p_token;
-        ScanType p_type;
-        std::ifstream p_fin;
-        std::istringstream p_sin;
-        size_t p_line = 1, p_column = 1;
+        // Value of a hexadecimal digit.
+        static unsigned int x2d(char c) {
+            if (isdigit(c))
+                return c - '0';
+            else if (isupper(c))
+                return c - 'A' + 10;
+            else 
+                return c - 'a' + 10;
+        }
+        // Appends the UTF-8 encoding of a \uXXXX escape.
+        static void utf8(unsigned int xnum, std::string& s) {
+            if (xnum <= 0x7F)
+                s += char(xnum);
+            else if (xnum <= 0x7FF) {
+                s += char(0xC0 | (xnum >> 6));
+                s += char(0x80 | (xnum & 0x3F));
+            }
+            else {
+                s += char(0xE0 | (xnum >> 12));
+                s += char(0x80 | ((xnum >> 6) & 0x3F));
+                s += char(0x80 | (xnum & 0x3F));
+            }
+        }
 
-    private:
-        bool p_eof() const {
-            return p_type == SCAN_FILE ? p_fin.eof() : p_sin.eof();
+        TokenType type() const {
+            return p_type;
+        }
+        // The name of a key, the undecoded body of a value or the message 
+        // of an error. Keys and values point into the text.
+        std::string_view text() const {
+            return p_text;
         }
-        char p_peek() {
-            return p_type == SCAN_FILE ? p_fin.peek() : p_sin.peek();
+        // Whether the value has any escape.
+        bool escaped() const {
+            return p_escaped;
         }
-        char p_get() {
-            return p_type == SCAN_FILE ? p_fin.get() : p_sin.get();
+        // Line and column of the token, both counted from 1, the column in 
+        // bytes.
+        std::string pos() const {
+            size_t line = 1;
+            const char* bol = p_begin;
+            for (const char* p = p_begin; (p = (const char*)memchr(p, '\n', p_start - p)) != nullptr; bol = ++p)
+                ++line;
+            return std::string("Line: ") + std::to_string(line) + " Column: " + std::to_string(p_start - bol + 1);
         }
-        void p_skip() {
-            char c = p_peek();
-            while (isspace(c)) {
-                if (c == '\n') {
-                    ++p_line;
-                    p_column = 1;
+
+        // Scans the next token and returns its type.
+        TokenType next() {
+            while (p_cur < p_end && chars.what[(unsigned char)*p_cur] == CHAR_SPACE)
+                ++p_cur;
+            p_start = p_cur;
+            if (p_cur == p_end)
+                p_type = TOKEN_EOF;
+            else {
+                p_type = TokenType(chars.what[(unsigned char)*p_cur] & CHAR_CLASS);
+                switch (p_type) {
+                    case (TOKEN_EOF):
+                        break;
+                    case (TOKEN_KEY): {
+                        const char* k = p_cur++;
+                        while (p_cur < p_end && (chars.what[(unsigned char)*p_cur] & CHAR_KEY))
+                            ++p_cur;
+                        p_text = std::string_view(k, p_cur - k);
+                        break;
+                    }
+                    case (TOKEN_VALUE):
+                        p_getValue();
+                        break;
+                    case (TOKEN_ERROR):
+                        p_text = "Invalid key";
+                        break;
+                    default:
+                        ++p_cur;
+                        break;
                 }
-                if (isblank(c))
-                    ++p_column;
-                p_get();
-                c = p_peek();
             }
+#ifdef SOL_ENABLE_STATS
+            if (p_stats != nullptr)
+                p_count();
+#endif
+            return p_type;
         }
-        unsigned int p_x2d(char c) {
-            if (isdigit(c))
-                return c - '0';
-            else if (isupper(c))
-                return c - 'A' + 10;
-            else 
-                return c - 'a' + 10;
+
+    private:
+        const char* p_begin;
+        const char* p_cur;
+        const char* p_end;
+        const char* p_start = nullptr;
+        TokenType p_type = TOKEN_EOF;
+        std::string_view p_text;
+        bool p_escaped = false;
+#ifdef SOL_ENABLE_STATS
+        Stats* p_stats = nullptr;
+        size_t p_depth = 0;
+
+        void p_count() {
+            ++p_stats->tokens[p_type];
+            if (p_type == TOKEN_LCBRACKET || p_type == TOKEN_LSBRACKET) {
+                if (++p_depth > p_stats->maxDepth)
+                    p_stats->maxDepth = p_depth;
+            }
+            else if ((p_type == TOKEN_RCBRACKET || p_type == TOKEN_RSBRACKET) && p_depth > 0)
+                --p_depth;
         }
-        std::string p_unescape() {
-            p_get();
-            ++p_column;
-            char c = p_peek();
+#endif
+
+    private:
+        // Passes over the escape whose backslash is right before p. A 
+        // \uXXXX escape ends at the first character which is not a 
+        // hexadecimal digit, that character included.
+        static const char* p_skipEscape(const char* p, const char* end) {
+            if (p == end)
+                return p;
+            if (*p != 'u')
+                return p + 1;
+            for (const char* d = p + 1; d < p + 5; ++d) {
+                if (d == end)
+                    return d;
+                if (!isxdigit((unsigned char)*d))
+                    return d + 1;
+            }
+            return p + 5;
+        }
+        // Same as p_skipEscape(), appending the decoded escape to s. A 
+        // broken \uXXXX escape is kept as it is, without the character 
+        // which broke it.
+        static const char* p_unescape(const char* p, const char* end, std::string& s) {
+            char c = p < end ? *p : EOF;
             switch (c) {
                 case ('t'):
-                    return "\t";
+                    s += '\t';
+                    break;
                 case ('n'):
-                    return "\n";
+                    s += '\n';
+                    break;
                 case ('r'):
-                    return "\r";
+                    s += '\r';
+                    break;
                 case ('"'):
-                    return "\"";
+                    s += '"';
+                    break;
                 case ('\\'):
-                    return "\\";
+                    s += '\\';
+                    break;
                 case ('u'): {
                     unsigned int xnum = 0;
-                    std::string xs;
-                    p_get();
-                    ++p_column;
-                    c = p_peek();
-                    if (!isxdigit(c))
-                        return std::string("\\u") + xs;
-                    xs += c;
-                    xnum = (xnum << 4) + p_x2d(c);
-                    p_get();
-                    ++p_column;
-                    c = p_peek();
-                    if (!isxdigit(c))
-                        return std::string("\\u") + xs;
-                    xs += c;
-                    xnum = (xnum << 4) + p_x2d(c);
-                    p_get();
-                    ++p_column;
-                    c = p_peek();
-                    if (!isxdigit(c))
-                        return std::string("\\u") + xs;
-                    xs += c;
-                    xnum = (xnum << 4) + p_x2d(c);
-                    p_get();
-                    ++p_column;
-                    c = p_peek();
-                    if (!isxdigit(c))
-                        return std::string("\\u") + xs;
-                    xnum = (xnum << 4) + p_x2d(c);
-                    if (xnum <= 0x7F)
-                        return std::string(1, xnum);
-                    else if (xnum <= 0x7FF){
-                        xs = "";
-                        xs += char(0xC0 | (xnum >> 6));
-                        xs += char(0x80 | (xnum & 0x3F));
-                        return xs;
+                    const char* q = p_skipEscape(p, end);
+                    for (const char* d = p + 1; d < q; ++d) {
+                        if (!isxdigit((unsigned char)*d)) {
+                            s += "\\u";
+                            s.append(p + 1, d);
+                            return q;
+                        }
+                        xnum = (xnum << 4) + x2d(*d);
                     }
-                    else {
-                        xs = "";
-                        xs += char(0xE0 | (xnum >> 12));
-                        xs += char(0x80 | ((xnum >> 6) & 0x3F));
-                        xs += char(0x80 | (xnum & 0x3F));
-                        return xs;
+                    if (q - p < 5) {
+                        s += "\\u";
+                        s.append(p + 1, q);
                     }
+                    else 
+                        utf8(xnum, s);
+                    return q;
                 }
                 default:
-                    return std::string("\\") + c;
+                    s += '\\';
+                    s += c;
             }
+            return p < end ? p + 1 : p;
         }
-
-        Token p_getValue() {
-            size_t line = p_line, column = p_column;
-            p_get();
-            ++p_column;
-            char c = p_peek();
-            std::string s;
-            while (c != EOF) {
-                if (c == '"')
-                    return Token(TOKEN_VALUE, line, column, s);
-                if (iscntrl(c))
-                    return Token(TOKEN_ERROR, line, column, "Invalid value character");
-                if (c == '\\')
-                    s += p_unescape();
-                else 
-                    s += c;
-                p_get();
-                c = p_peek();
-                ++p_column;
+        // Returns the character which ends the value body starting at p: a 
+        // quote, a control character, 0xFF or end. escaped is set if the 
+        // body has any escape.
+        static const char* p_skipBody(const char* p, const char* end, bool& escaped) {
+            while (true) {
+                p = findValueStop(p, end);
+                if (p == end || *p != '\\')
+                    return p;
+                escaped = true;
+                p = p_skipEscape(p + 1, end);
+            }
+        }
+        void p_getValue() {
+            const char* begin = p_cur + 1;
+            p_escaped = false;
+            const char* q = p_skipBody(begin, p_end, p_escaped);
+            if (q == p_end || chars.what[(unsigned char)*q] == TOKEN_EOF) {
+                p_cur = q;
+                p_type = TOKEN_ERROR;
+                p_text = "Incomplete value";
+            }
+            else if (*q != '"') {
+                p_cur = q;
+                p_type = TOKEN_ERROR;
+                p_text = "Invalid value character";
             }
-            return Token(TOKEN_ERROR, line, column, "Incomplete value");
-        }
-        Token p_getKey() {
-            size_t line = p_line, column = p_column;
-            std::string k(1, p_peek());
-            p_get();
-            ++p_column;
-            char c = p_peek();
-            while (isalpha(c) || isdigit(c) || c == '_') {
-                k += c;
-                p_get();
-                c = p_peek();
+            else {
+                p_text = std::string_view(begin, q - begin);
+                p_cur = q + 1;
             }
-            return Token(TOKEN_KEY, line, column, k);
         }
 };
 
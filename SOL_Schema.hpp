@@ -0,0 +1,313 @@
+#ifndef SOL_SCHEMA_HPP_INCLUDED
+#define SOL_SCHEMA_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+
+#include "SOL_Path.hpp"
+#include "SOL_Value.hpp"
+
+namespace sol {
+
+template <class H>
+class Validator;
+
+// Rules in the "path:Type" notation of check(), merged into a trie of 
+// their steps. A rule ending with '?' ("a.b:String?") is optional: it also 
+// passes when its path does not exist. A step "*" stands for every element 
+// of an array ("items.*.name:String"). Otherwise a rule passes exactly 
+// when check() does: a missing key reads as Null, while a missing index or 
+// a step into a value of the wrong kind fails.
+class Schema {
+    public:
+        Schema() {
+            p_nodes.emplace_back(Path::Step(std::string_view()));
+        }
+        Schema(const std::vector<std::string>& ls): Schema() {
+            for (auto& i : ls)
+                add(i);
+        }
+
+        // Returns false, keeping the first such error, if s is not a 
+        // valid rule.
+        bool add(std::string_view s) {
+            size_t p = s.find_first_of(':');
+            if (p == s.npos)
+                return p_invalid(s);
+            std::string_view lb = s.substr(p + 1);
+            bool optional = !lb.empty() && lb.back() == '?';
+            if (optional)
+                lb.remove_suffix(1);
+            ValueType t;
+            if (lb == "Array")
+                t = VALUE_ARRAY;
+            else if (lb == "Object")
+                t = VALUE_OBJECT;
+            else if (lb == "String")
+                t = VALUE_STRING;
+            else if (lb == "Null")
+                t = VALUE_NULL;
+            else 
+                return p_invalid(s);
+            Path path(s.substr(0, p));
+            if (!path.valid())
+                return p_invalid(s);
+
+            size_t rule = p_rules.size();
+            p_rules.push_back({std::string(s), t, optional});
+            size_t n = 0;
+            for (const Path::Step& i : path.p_steps) {
+                size_t c = p_nodes[n].child;
+                while (c != 0 && !(p_nodes[c].step == i))
+                    c = p_nodes[c].sibling;
+                if (c == 0) {
+                    c = p_nodes.size();
+                    p_nodes.emplace_back(i);
+                    p_nodes[c].any = !i.index && i.key == "*";
+                    p_nodes[c].sibling = p_nodes[n].child;
+                    p_nodes[c].rule = rule;
+                    p_nodes[n].child = c;
+                }
+                // Nothing below a step can be required if it is absent.
+                if (!optional)
+                    p_nodes[c].required = true;
+                n = c;
+            }
+            if (!optional && t != VALUE_NULL)
+                p_nodes[n].needed = true;
+            p_nodes[n].checks.push_back(rule);
+            return true;
+        }
+
+        bool valid() const {
+            return p_error.empty();
+        }
+        const std::string& error() const {
+            return p_error;
+        }
+
+        // Validates an existing value in one walk, msg is set to the first 
+        // violation.
+        bool validate(const Value& v, std::string& msg) const {
+            return p_validate(0, v, msg);
+        }
+        bool validate(const Value& v) const {
+            std::string msg;
+            return validate(v, msg);
+        }
+
+    private:
+        template <class H>
+        friend class Validator;
+
+        struct Rule {
+            std::string text;
+            ValueType type;
+            bool optional;
+        };
+        // Children are a linked list through indexes, 0 ends it (node 0 is 
+        // the root). required tells that a non-optional rule ends at or 
+        // below the node, so it may not be a missing index; needed that one 
+        // ends at it with another type than Null, so it may not be a 
+        // missing key either. rule is one of the rules through the node, 
+        // to name in messages.
+        struct Node {
+            Path::Step step;
+            bool any = false;
+            bool required = false;
+            bool needed = false;
+            size_t child = 0;
+            size_t sibling = 0;
+            size_t rule = 0;
+            std::vector<size_t> checks;
+
+            Node(const Path::Step& s): step(s) {}
+        };
+
+        std::vector<Node> p_nodes;
+        std::vector<Rule> p_rules;
+        std::string p_error;
+
+    private:
+        bool p_invalid(std::string_view s) {
+            if (p_error.empty())
+                p_error = "Invalid schema rule " + std::string(s);
+            return false;
+        }
+        bool p_fail(size_t n, std::string& msg) const {
+            msg = "Schema violation " + p_rules[p_nodes[n].rule].text;
+            return false;
+        }
+        // Whether the node may be absent: a missing key reads as Null, so 
+        // only rules below it fail, while a missing index fails all.
+        bool p_absent(size_t n) const {
+            const Node& t = p_nodes[n];
+            if (t.step.index)
+                return !t.required;
+            if (t.needed)
+                return false;
+            for (size_t c = t.child; c != 0; c = p_nodes[c].sibling)
+                if (p_nodes[c].required)
+                    return false;
+            return true;
+        }
+        // The rules ending at node n and the steps of its children that 
+        // cannot apply to a value of type t.
+        bool p_type(size_t n, ValueType t, std::string& msg) const {
+            for (size_t i : p_nodes[n].checks)
+                if (p_rules[i].type != t) {
+                    msg = "Schema violation " + p_rules[i].text;
+                    return false;
+                }
+            for (size_t c = p_nodes[n].child; c != 0; c = p_nodes[c].sibling) {
+                bool array = p_nodes[c].any || p_nodes[c].step.index;
+                if (array ? t != VALUE_ARRAY : t != VALUE_OBJECT)
+                    return p_fail(c, msg);
+            }
+            return true;
+        }
+        bool p_validate(size_t n, const Value& v, std::string& msg) const {
+            if (!p_type(n, v.type(), msg))
+                return false;
+            for (size_t c = p_nodes[n].child; c != 0; c = p_nodes[c].sibling) {
+                const Node& t = p_nodes[c];
+                if (t.any) {
+                    for (auto& i : v.array())
+                        if (!p_validate(c, i, msg))
+                            return false;
+                    continue;
+                }
+                bool missing = false;
+                const Value* e = t.step.find(v, missing);
+                if (e == nullptr) {
+                    if (!p_absent(c))
+                        return p_fail(c, msg);
+                }
+                else if (!p_validate(c, *e, msg))
+                    return false;
+            }
+            return true;
+        }
+};
+
+// Handler passing the events on to h while validating them against a 
+// schema, it aborts the parse at the first violation. Each occurrence of 
+// a repeated key is validated.
+template <class H>
+class Validator {
+    public:
+        Validator(const Schema& s, H& h): p_schema(s), p_handler(h) {}
+        Validator(const Validator&) = delete;
+        ~Validator() = default;
+
+        Validator& operator=(const Validator&) = delete;
+
+        // Empty unless the schema was violated.
+        const std::string& violation() const {
+            return p_violation;
+        }
+
+        bool onBeginArray() {
+            return p_value(VALUE_ARRAY) && p_handler.onBeginArray();
+        }
+        bool onEndArray() {
+            return p_end() && p_handler.onEndArray();
+        }
+        bool onBeginObject() {
+            return p_value(VALUE_OBJECT) && p_handler.onBeginObject();
+        }
+        bool onKey(std::string_view k) {
+            Frame& f = p_frames.back();
+            p_active.resize(f.end);
+            for (size_t i = f.begin; i < f.end; ++i)
+                for (size_t c = p_node(p_active[i]).child; c != 0; c = p_node(c).sibling)
+                    if (!p_node(c).step.index && p_node(c).step.key == k) {
+                        p_active.push_back(c);
+                        p_seen.push_back(c);
+                    }
+            return p_handler.onKey(k);
+        }
+        bool onEndObject() {
+            return p_end() && p_handler.onEndObject();
+        }
+        bool onValue(std::string_view v) {
+            return p_value(VALUE_STRING) && p_handler.onValue(v);
+        }
+        template <class T = H>
+        auto onRawValue(std::string_view v, bool escaped) -> decltype(std::declval<T&>().onRawValue(v, escaped)) {
+            return p_value(VALUE_STRING) && p_handler.onRawValue(v, escaped);
+        }
+
+    private:
+        // A container being parsed: its nodes are p_active[begin, end), the 
+        // keys seen so far p_seen[seen, ...).
+        struct Frame {
+            size_t begin;
+            size_t end;
+            size_t seen;
+            size_t count;
+            bool array;
+        };
+
+        const Schema& p_schema;
+        H& p_handler;
+        std::string p_violation;
+        std::vector<Frame> p_frames;
+        std::vector<size_t> p_active;
+        std::vector<size_t> p_seen;
+
+    private:
+        const Schema::Node& p_node(size_t n) const {
+            return p_schema.p_nodes[n];
+        }
+        // Nodes of a new value are appended to p_active: the root, the 
+        // children of an array for its next element, or those onKey() 
+        // found for an object.
+        bool p_value(ValueType t) {
+            size_t begin = p_active.size();
+            if (p_frames.empty())
+                p_active.push_back(0);
+            else if (p_frames.back().array) {
+                Frame& f = p_frames.back();
+                begin = f.end;
+                p_active.resize(begin);
+                for (size_t i = f.begin; i < f.end; ++i)
+                    for (size_t c = p_node(p_active[i]).child; c != 0; c = p_node(c).sibling)
+                        if (p_node(c).any || (p_node(c).step.index && p_node(c).step.pos == f.count))
+                            p_active.push_back(c);
+                ++f.count;
+            }
+            else 
+                begin = p_frames.back().end;
+            for (size_t i = begin; i < p_active.size(); ++i)
+                if (!p_schema.p_type(p_active[i], t, p_violation))
+                    return false;
+            if (t != VALUE_STRING)
+                p_frames.push_back({begin, p_active.size(), p_seen.size(), 0, t == VALUE_ARRAY});
+            return true;
+        }
+        // Checks the children that never showed up.
+        bool p_end() {
+            Frame f = p_frames.back();
+            for (size_t i = f.begin; i < f.end; ++i)
+                for (size_t c = p_node(p_active[i]).child; c != 0; c = p_node(c).sibling) {
+                    if (p_node(c).any)
+                        continue;
+                    bool absent = f.array ? p_node(c).step.pos >= f.count : 
+                        std::find(p_seen.begin() + f.seen, p_seen.end(), c) == p_seen.end();
+                    if (absent && !p_schema.p_absent(c))
+                        return p_schema.p_fail(c, p_violation);
+                }
+            p_frames.pop_back();
+            p_active.resize(f.begin);
+            p_seen.resize(f.seen);
+            return true;
+        }
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,296 @@
+#ifndef SOL_SIMD_HPP_INCLUDED
+#define SOL_SIMD_HPP_INCLUDED
+
+#include <cstddef>
+
+#if !defined(SOL_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define SOL_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace sol {
+namespace internal {
+
+// A value body ends at the first '"', '\\', control character or 0xFF 
+// (which reads as EOF).
+inline bool isValueStop(unsigned char c) {
+    return c == '"' || c == '\\' || c < 0x20 || c == 0x7F || c == 0xFF;
+}
+
+inline const char* findValueStopScalar(const char* p, const char* end) {
+    while (p < end && !isValueStop(*p))
+        ++p;
+    return p;
+}
+
+#if defined(SOL_SIMD_X86)
+inline const char* findValueStopSse2(const char* p, const char* end) {
+    const __m128i q = _mm_set1_epi8('"');
+    const __m128i bs = _mm_set1_epi8('\\');
+    const __m128i del = _mm_set1_epi8(0x7F);
+    const __m128i ff = _mm_set1_epi8(-1);
+    const __m128i ctl = _mm_set1_epi8(0x1F);
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)p);
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(x, q), _mm_cmpeq_epi8(x, bs)), 
+            _mm_or_si128(_mm_cmpeq_epi8(x, del), _mm_cmpeq_epi8(x, ff))
+        );
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_max_epu8(x, ctl), ctl));
+        int mask = _mm_movemask_epi8(m);
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return findValueStopScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+inline const char* findValueStopAvx2(const char* p, const char* end) {
+    const __m256i q = _mm256_set1_epi8('"');
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    const __m256i ff = _mm256_set1_epi8(-1);
+    const __m256i ctl = _mm256_set1_epi8(0x1F);
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)p);
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(x, q), _mm256_cmpeq_epi8(x, bs)), 
+            _mm256_or_si256(_mm256_cmpeq_epi8(x, del), _mm256_cmpeq_epi8(x, ff))
+        );
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(_mm256_max_epu8(x, ctl), ctl));
+        unsigned int mask = _mm256_movemask_epi8(m);
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return findValueStopSse2(p, end);
+}
+#endif
+
+// Returns the first value stop in [p, end), or end if there is none. The 
+// widest kernel the CPU supports is picked on first use.
+inline const char* findValueStop(const char* p, const char* end) {
+#if defined(SOL_SIMD_X86)
+    using Kernel = const char* (*)(const char*, const char*);
+    static const Kernel kernel = __builtin_cpu_supports("avx2") ? findValueStopAvx2 : findValueStopSse2;
+    return kernel(p, end);
+#else
+    return findValueStopScalar(p, end);
+#endif
+}
+
+// Writing a value has to stop at the characters it escapes, and with high 
+// set at every byte of a multibyte character.
+inline bool isEscapeStop(unsigned char c, bool high) {
+    return c == '"' || c == '\\' || c == '\t' || c == '\n' || c == '\r' || (high && c > 0x7F);
+}
+
+inline const char* findEscapeStopScalar(const char* p, const char* end, bool high) {
+    while (p < end && !isEscapeStop(*p, high))
+        ++p;
+    return p;
+}
+
+#if defined(SOL_SIMD_X86)
+inline const char* findEscapeStopSse2(const char* p, const char* end, bool high) {
+    const __m128i q = _mm_set1_epi8('"');
+    const __m128i bs = _mm_set1_epi8('\\');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const int highMask = high ? 0xFFFF : 0;
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)p);
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(x, q), _mm_cmpeq_epi8(x, bs)), 
+            _mm_or_si128(_mm_cmpeq_epi8(x, tab), _mm_or_si128(_mm_cmpeq_epi8(x, lf), _mm_cmpeq_epi8(x, cr)))
+        );
+        int mask = _mm_movemask_epi8(m) | (_mm_movemask_epi8(x) & highMask);
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return findEscapeStopScalar(p, end, high);
+}
+
+__attribute__((target("avx2")))
+inline const char* findEscapeStopAvx2(const char* p, const char* end, bool high) {
+    const __m256i q = _mm256_set1_epi8('"');
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const unsigned int highMask = high ? ~0u : 0;
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)p);
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(x, q), _mm256_cmpeq_epi8(x, bs)), 
+            _mm256_or_si256(_mm256_cmpeq_epi8(x, tab), _mm256_or_si256(_mm256_cmpeq_epi8(x, lf), _mm256_cmpeq_epi8(x, cr)))
+        );
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(m) | ((unsigned int)_mm256_movemask_epi8(x) & highMask);
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return findEscapeStopSse2(p, end, high);
+}
+#endif
+
+// Returns the first character to escape in [p, end), or end if there is 
+// none.
+inline const char* findEscapeStop(const char* p, const char* end, bool high) {
+#if defined(SOL_SIMD_X86)
+    using Kernel = const char* (*)(const char*, const char*, bool);
+    static const Kernel kernel = __builtin_cpu_supports("avx2") ? findEscapeStopAvx2 : findEscapeStopSse2;
+    return kernel(p, end, high);
+#else
+    return findEscapeStopScalar(p, end, high);
+#endif
+}
+
+// Skipping a container only has to stop at quotes and brackets.
+inline bool isBracketStop(unsigned char c) {
+    return c == '"' || (c | 0x20) == '{' || (c | 0x20) == '}';
+}
+
+inline const char* findBracketStopScalar(const char* p, const char* end) {
+    while (p < end && !isBracketStop(*p))
+        ++p;
+    return p;
+}
+
+#if defined(SOL_SIMD_X86)
+inline const char* findBracketStopSse2(const char* p, const char* end) {
+    const __m128i q = _mm_set1_epi8('"');
+    const __m128i lb = _mm_set1_epi8('{');
+    const __m128i rb = _mm_set1_epi8('}');
+    const __m128i low = _mm_set1_epi8(0x20);
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)p);
+        __m128i y = _mm_or_si128(x, low);
+        __m128i m = _mm_or_si128(
+            _mm_cmpeq_epi8(x, q), 
+            _mm_or_si128(_mm_cmpeq_epi8(y, lb), _mm_cmpeq_epi8(y, rb))
+        );
+        int mask = _mm_movemask_epi8(m);
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return findBracketStopScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+inline const char* findBracketStopAvx2(const char* p, const char* end) {
+    const __m256i q = _mm256_set1_epi8('"');
+    const __m256i lb = _mm256_set1_epi8('{');
+    const __m256i rb = _mm256_set1_epi8('}');
+    const __m256i low = _mm256_set1_epi8(0x20);
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)p);
+        __m256i y = _mm256_or_si256(x, low);
+        __m256i m = _mm256_or_si256(
+            _mm256_cmpeq_epi8(x, q), 
+            _mm256_or_si256(_mm256_cmpeq_epi8(y, lb), _mm256_cmpeq_epi8(y, rb))
+        );
+        unsigned int mask = _mm256_movemask_epi8(m);
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return findBracketStopSse2(p, end);
+}
+#endif
+
+// Returns the first quote or bracket in [p, end), or end if there is none.
+inline const char* findBracketStop(const char* p, const char* end) {
+#if defined(SOL_SIMD_X86)
+    using Kernel = const char* (*)(const char*, const char*);
+    static const Kernel kernel = __builtin_cpu_supports("avx2") ? findBracketStopAvx2 : findBracketStopSse2;
+    return kernel(p, end);
+#else
+    return findBracketStopScalar(p, end);
+#endif
+}
+
+
+// Indexing the structure of a text stops at quotes, brackets, '=', ',' and 
+// 0xFF.
+inline bool isStructStop(unsigned char c) {
+    return isBracketStop(c) || c == '=' || c == ',' || c == 0xFF;
+}
+
+inline const char* findStructStopScalar(const char* p, const char* end) {
+    while (p < end && !isStructStop(*p))
+        ++p;
+    return p;
+}
+
+#if defined(SOL_SIMD_X86)
+inline const char* findStructStopSse2(const char* p, const char* end) {
+    const __m128i q = _mm_set1_epi8('"');
+    const __m128i lb = _mm_set1_epi8('{');
+    const __m128i rb = _mm_set1_epi8('}');
+    const __m128i eq = _mm_set1_epi8('=');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i ff = _mm_set1_epi8(-1);
+    const __m128i low = _mm_set1_epi8(0x20);
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)p);
+        __m128i y = _mm_or_si128(x, low);
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(x, q), _mm_cmpeq_epi8(x, ff)), 
+            _mm_or_si128(_mm_cmpeq_epi8(y, lb), _mm_cmpeq_epi8(y, rb))
+        );
+        m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(x, eq), _mm_cmpeq_epi8(x, comma)));
+        int mask = _mm_movemask_epi8(m);
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return findStructStopScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+inline const char* findStructStopAvx2(const char* p, const char* end) {
+    const __m256i q = _mm256_set1_epi8('"');
+    const __m256i lb = _mm256_set1_epi8('{');
+    const __m256i rb = _mm256_set1_epi8('}');
+    const __m256i eq = _mm256_set1_epi8('=');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i ff = _mm256_set1_epi8(-1);
+    const __m256i low = _mm256_set1_epi8(0x20);
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)p);
+        __m256i y = _mm256_or_si256(x, low);
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(x, q), _mm256_cmpeq_epi8(x, ff)), 
+            _mm256_or_si256(_mm256_cmpeq_epi8(y, lb), _mm256_cmpeq_epi8(y, rb))
+        );
+        m = _mm256_or_si256(m, _mm256_or_si256(_mm256_cmpeq_epi8(x, eq), _mm256_cmpeq_epi8(x, comma)));
+        unsigned int mask = _mm256_movemask_epi8(m);
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return findStructStopSse2(p, end);
+}
+#endif
+
+// Returns the first structural character in [p, end), or end if there is 
+// none.
+inline const char* findStructStop(const char* p, const char* end) {
+#if defined(SOL_SIMD_X86)
+    using Kernel = const char* (*)(const char*, const char*);
+    static const Kernel kernel = __builtin_cpu_supports("avx2") ? findStructStopAvx2 : findStructStopSse2;
+    return kernel(p, end);
+#else
+    return findStructStopScalar(p, end);
+#endif
+}
+
+}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+#ifndef SOL_SINK_HPP_INCLUDED
+#define SOL_SINK_HPP_INCLUDED
+
+#include <cstdio>
+#include <cstring>
+
+#include <string>
+#include <algorithm>
+#include <ostream>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace sol {
+
+// Buffered output of a Writer. Everything put is collected in a fixed size 
+// buffer and handed to p_write() when that is full or on flush(), derived 
+// sinks only decide where it goes.
+class Sink {
+    public:
+        Sink() = default;
+        Sink(const Sink&) = delete;
+        virtual ~Sink() = default;
+
+        Sink& operator=(const Sink&) = delete;
+
+        void put(char c) {
+            if (p_len == sizeof(p_buf))
+                flush();
+            p_buf[p_len++] = c;
+        }
+        void write(const char* s, size_t len) {
+            if (len > sizeof(p_buf) - p_len) {
+                flush();
+                if (len >= sizeof(p_buf)) {
+#ifdef SOL_ENABLE_STATS
+                    p_written += len;
+#endif
+                    p_good = p_write(s, len) && p_good;
+                    return;
+                }
+            }
+            memcpy(p_buf + p_len, s, len);
+            p_len += len;
+        }
+        void fill(char c, size_t len) {
+            while (len) {
+                if (p_len == sizeof(p_buf))
+                    flush();
+                size_t t = std::min(len, sizeof(p_buf) - p_len);
+                memset(p_buf + p_len, c, t);
+                p_len += t;
+                len -= t;
+            }
+        }
+        // Hands the buffer over, returns false if any output has failed.
+        bool flush() {
+            if (p_len) {
+#ifdef SOL_ENABLE_STATS
+                p_written += p_len;
+#endif
+                p_good = p_write(p_buf, p_len) && p_good;
+                p_len = 0;
+            }
+            return p_good;
+        }
+        bool good() const {
+            return p_good;
+        }
+#ifdef SOL_ENABLE_STATS
+        // Bytes handed over so far.
+        size_t written() const {
+            return p_written;
+        }
+#endif
+
+    protected:
+        virtual bool p_write(const char* s, size_t len) = 0;
+
+    private:
+        char p_buf[8192];
+        size_t p_len = 0;
+        bool p_good = true;
+#ifdef SOL_ENABLE_STATS
+        size_t p_written = 0;
+#endif
+};
+
+class FileSink: public Sink {
+    public:
+        FileSink(FILE* f): p_file(f) {}
+        ~FileSink() {
+            flush();
+        }
+
+    protected:
+        bool p_write(const char* s, size_t len) override {
+            return fwrite(s, 1, len, p_file) == len;
+        }
+
+    private:
+        FILE* p_file;
+};
+
+class FdSink: public Sink {
+    public:
+        FdSink(int fd): p_fd(fd) {}
+        ~FdSink() {
+            flush();
+        }
+
+    protected:
+        bool p_write(const char* s, size_t len) override {
+            while (len) {
+#if defined(_WIN32)
+                int t = _write(p_fd, s, (unsigned int)std::min(len, size_t(1) << 30));
+#else
+                ssize_t t = ::write(p_fd, s, len);
+#endif
+                if (t <= 0)
+                    return false;
+                s += t;
+                len -= t;
+            }
+            return true;
+        }
+
+    private:
+        int p_fd;
+};
+
+class StreamSink: public Sink {
+    public:
+        StreamSink(std::ostream& os): p_os(os) {}
+        ~StreamSink() {
+            flush();
+        }
+
+    protected:
+        bool p_write(const char* s, size_t len) override {
+            return (bool)p_os.write(s, len);
+        }
+
+    private:
+        std::ostream& p_os;
+};
+
+class StringSink: public Sink {
+    public:
+        StringSink(std::string& s): p_str(s) {}
+        ~StringSink() {
+            flush();
+        }
+
+    protected:
+        bool p_write(const char* s, size_t len) override {
+            p_str.append(s, len);
+            return true;
+        }
+
+    private:
+        std::string& p_str;
+};
+
+}
+
+#endif
\ No newline at end of file
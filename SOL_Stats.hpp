@@ -0,0 +1,77 @@
+#ifndef SOL_STATS_HPP_INCLUDED
+#define SOL_STATS_HPP_INCLUDED
+
+#include <cstddef>
+
+#include <chrono>
+
+#include "SOL_Token.hpp"
+
+// Everything here only exists if SOL_ENABLE_STATS is defined before SOL 
+// is included (the same way in every file of a program), otherwise the 
+// counting is compiled out.
+#ifdef SOL_ENABLE_STATS
+
+namespace sol {
+
+// Counters of the parses of a Reader and the output of a Writer, see 
+// Reader::stats() and Writer::stats(). They add up over every call made 
+// while they are set, assign Stats() to start over.
+struct Stats {
+    // Text scanned, or written.
+    size_t bytes = 0;
+    // Tokens scanned, indexed by internal::TokenType.
+    size_t tokens[internal::TOKEN_VALUE + 1] = {};
+    // Deepest nesting of arrays and objects seen.
+    size_t maxDepth = 0;
+    // Values whose escapes were decoded, or which needed escaping.
+    size_t escapes = 0;
+    // Values built by the reader itself (not handler events), or written.
+    size_t nodes = 0;
+    // Heap blocks asked for by the reader for the values it built: object 
+    // nodes, array buffers as they grow, members of objects as they are 
+    // added and strings too long for their inline buffer, only such keys 
+    // with an arena. What the containers keep besides (hash buckets) is 
+    // left out.
+    size_t allocations = 0;
+    // Arrays and objects deep copied during the calls (see Value::copies()), 
+    // shared ones aside. Values are moved all the way from the text to the 
+    // result and back to text, so anything but 0 is a copy to get rid of.
+    size_t copies = 0;
+    // Time spent in the calls, and the time of a pass which only scans the 
+    // tokens of the same text. That pass is made before each parse while 
+    // the stats are set and is not part of seconds, seconds - scanSeconds 
+    // is about the handler or tree building time.
+    double seconds = 0;
+    double scanSeconds = 0;
+};
+
+namespace internal {
+
+// Adds the time until it is destroyed to a field of the stats, if any.
+class StatsTimer {
+    public:
+        StatsTimer(Stats* s, double Stats::* field): p_stats(s), p_field(field) {
+            if (p_stats != nullptr)
+                p_start = std::chrono::steady_clock::now();
+        }
+        StatsTimer(const StatsTimer&) = delete;
+        ~StatsTimer() {
+            if (p_stats != nullptr)
+                p_stats->*p_field += std::chrono::duration<double>(std::chrono::steady_clock::now() - p_start).count();
+        }
+
+        StatsTimer& operator=(const StatsTimer&) = delete;
+
+    private:
+        Stats* p_stats;
+        double Stats::* p_field;
+        std::chrono::steady_clock::time_point p_start;
+};
+
+}
+}
+
+#endif
+
+#endif
\ No newline at end of file
@@ -1,16 +1,40 @@
 #ifndef SOL_VALUE_HPP_INCLUDED
 #define SOL_VALUE_HPP_INCLUDED
 
+#include <new>
+#include <cctype>
+#include <cstring>
 #include <vector>
 #include <string>
+#include <charconv>
+#include <atomic>
 #include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include <system_error>
 #include <unordered_map>
 
+#include "SOL_Arena.hpp"
+#include "SOL_Scanner.hpp"
+#include "SOL_FlatObject.hpp"
+
 namespace sol {
 
 class Value;
-using Array = std::vector<Value>;
-using Object = std::unordered_map<std::string, Value>;
+class Builder;
+// Containers allocate from the heap unless they were made for an arena, 
+// see ArenaAllocator.
+using Array = std::vector<Value, ArenaAllocator<Value>>;
+// Defining SOL_FLAT_OBJECT stores objects as insertion ordered FlatObject 
+// vectors instead of hash maps. Members then move when one is added or 
+// erased: a reference or pointer to a member is only good until the next 
+// operator[] with a new key, emplace() or erase() on the same object, 
+// unlike with std::unordered_map.
+#ifdef SOL_FLAT_OBJECT
+using Object = FlatObject<Value, ArenaAllocator<Value>>;
+#else
+using Object = std::unordered_map<std::string, Value, std::hash<std::string>, std::equal_to<std::string>, ArenaAllocator<std::pair<const std::string, Value>>>;
+#endif
 using String = std::string;
 
 using ValueType = enum ___ {
@@ -20,112 +44,145 @@ using ValueType = enum ___ {
     VALUE_STRING
 };
 
+// Tagged union. Strings (with their own short string buffer) and array 
+// headers are stored inline, objects are too large for that and live on 
+// the heap or in an arena. A value built for an arena keeps all of its 
+// storage there: objects, the buffers of arrays and objects, and the text 
+// of strings too long for their own buffer, held as a view of the arena. 
+// A string may also be borrowed: a view of SOL text owned by someone else, 
+// copied only once it is asked for as a String. Integers, reals and 
+// booleans are strings too, kept as numbers next to their text, which is 
+// formatted when they are set. Const member functions change nothing, so 
+// a value can be read from several threads at once. An array or an object 
+// can also be shared, see share().
 class Value {
     public:
-        Value(): p_type(VALUE_NULL), p_data(nullptr) {}
-        Value(const Value& t) {*this = t;}
-        Value(Value&& t) {*this = std::forward<Value>(t);}
-        Value(const Array& t) {*this = t;}
-        Value(Array&& t) {*this = std::forward<Array>(t);}
-        Value(const Object& t) {*this = t;}
-        Value(Object&& t) {*this = std::forward<Object>(t);}
-        Value(const String& t) {*this = t;}
-        Value(String&& t) {*this = std::forward<String>(t);}
-        Value(long long t) {*this = t;}
-        Value(double t) {*this = t;}
-        Value(bool t) {*this = t;}
+        Value(): p_number() {}
+        Value(const Value& t) {p_copy(t);}
+        Value(Value&& t) noexcept {p_move(t);}
+        Value(const Array& t): p_type(VALUE_ARRAY) {new (&p_array) Array(t);}
+        Value(Array&& t): p_type(VALUE_ARRAY) {new (&p_array) Array(std::forward<Array>(t));}
+        Value(const Object& t): p_type(VALUE_OBJECT) {p_object = new Object(t);}
+        Value(Object&& t): p_type(VALUE_OBJECT) {p_object = new Object(std::forward<Object>(t));}
+        Value(const String& t): p_type(VALUE_STRING) {new (&p_string) String(t);}
+        Value(String&& t): p_type(VALUE_STRING) {new (&p_string) String(std::forward<String>(t));}
+        Value(long long t): p_type(VALUE_STRING), p_kind(KIND_INTEGER) {p_number.i = t; p_format();}
+        Value(double t): p_type(VALUE_STRING), p_kind(KIND_REAL) {p_number.d = t; p_format();}
+        Value(bool t): p_type(VALUE_STRING), p_kind(KIND_BOOLEAN) {p_number.i = t;}
+        // The elements or members of t are moved into the arena, unless t 
+        // allocates from it already.
+        Value(Array&& t, Arena& a): p_type(VALUE_ARRAY) {
+            new (&p_array) Array(std::forward<Array>(t), ArenaAllocator<Value>(&a));
+        }
+        Value(Object&& t, Arena& a): p_type(VALUE_OBJECT), p_arena(true) {
+            p_object = new (a.allocate(sizeof(Object), alignof(Object))) Object(std::forward<Object>(t), Object::allocator_type(&a));
+        }
+        Value(String&& t, Arena& a): Value(p_inArena(t, a)) {}
         ~Value() {p_clear();}
 
+        // The text stays owned by the caller and must outlive the value. 
+        // escaped tells that it still contains SOL escapes, it is then 
+        // decoded into a String right away.
+        static Value borrow(const char* data, size_t len, bool escaped = false) {
+            if (escaped) {
+                String s;
+                internal::Scanner::unescape(data, data + len, s);
+                return Value(std::move(s));
+            }
+            Value rtn;
+            rtn.p_view = std::string_view(data, len);
+            rtn.p_type = VALUE_STRING;
+            rtn.p_kind = KIND_VIEW;
+            return rtn;
+        }
+
+        // Moves every array and object of this value into reference counted 
+        // nodes that are never changed again, so copies of it (or of any 
+        // part of it) only take a reference and can be read from several 
+        // threads. Borrowed strings and those in an arena are copied on the 
+        // way, arrays and objects are moved out of their arena. Changing a 
+        // shared array or object through a non-const accessor first copies 
+        // its node, which takes references to the children, unless nothing 
+        // else refers to it.
+        Value& share();
+        bool isShared() const {
+            return p_shared;
+        }
+#ifdef SOL_ENABLE_STATS
+        // Arrays and objects copied on this thread so far, shared ones 
+        // aside, see Stats::copies.
+        static size_t copies() {
+            return p_copies();
+        }
+#endif
+
         Value& operator=(const Value& t) {
+            Value v(t);
             p_clear();
-            p_type = t.p_type;
-            switch (p_type) {
-                case (VALUE_NULL):
-                    break;
-                case (VALUE_ARRAY):
-                    p_data = new Array(*(Array*)t.p_data);
-                    break;
-                case (VALUE_OBJECT):
-                    p_data = new Object(*(Object*)t.p_data);
-                    break;
-                case (VALUE_STRING):
-                    p_data = new String(*(String*)t.p_data);
-                    break;
-            }
+            p_move(v);
             return *this;
         }
-        Value& operator=(Value&& t) {
+        Value& operator=(Value&& t) noexcept {
+            Value v(std::forward<Value>(t));
             p_clear();
-            std::swap(p_type, t.p_type);
-            std::swap(p_data, t.p_data);
+            p_move(v);
             return *this;
         }
         Value& operator=(const Array& t) {
-            p_clear();
-            p_type = VALUE_ARRAY;
-            p_data = new Array(t);
-            return *this;
+            return *this = Value(t);
         }
         Value& operator=(Array&& t) {
-            p_clear();
-            p_type = VALUE_ARRAY;
-            p_data = new Array(std::forward<Array>(t));
-            return *this;
+            return *this = Value(std::forward<Array>(t));
         }
         Value& operator=(const Object& t) {
-            p_clear();
-            p_type = VALUE_OBJECT;
-            p_data = new Object(t);
-            return *this;
+            return *this = Value(t);
         }
         Value& operator=(Object&& t) {
-            p_clear();
-            p_type = VALUE_OBJECT;
-            p_data = new Object(std::forward<Object>(t));
-            return *this;
+            return *this = Value(std::forward<Object>(t));
         }
         Value& operator=(const String& t) {
-            p_clear();
-            p_type = VALUE_STRING;
-            p_data = new String(t);
-            return *this;
+            return *this = Value(t);
         }
         Value& operator=(String&& t) {
-            p_clear();
-            p_type = VALUE_STRING;
-            p_data = new String(std::forward<String>(t));
-            return *this;
+            return *this = Value(std::forward<String>(t));
         }
         Value& operator=(long long t) {
             p_clear();
             p_type = VALUE_STRING;
-            p_data = new String(std::to_string(t));
+            p_kind = KIND_INTEGER;
+            p_number.i = t;
+            p_format();
             return *this;
         }
         Value& operator=(double t) {
             p_clear();
             p_type = VALUE_STRING;
-            p_data = new String(std::to_string(t));
+            p_kind = KIND_REAL;
+            p_number.d = t;
+            p_format();
             return *this;
         }
         Value& operator=(bool t) {
             p_clear();
             p_type = VALUE_STRING;
-            p_data = new String(t ? "true" : "false");
+            p_kind = KIND_BOOLEAN;
+            p_number.i = t;
             return *this;
         }
 
         Value& operator[](size_t t) {
             if (p_type != VALUE_ARRAY)
                 *this = Array();
-            if (((Array*)p_data)->size() <= t)
-                ((Array*)p_data)->resize(t + 1);
-            return (*(Array*)p_data)[t];
+            p_detach();
+            if (p_array.size() <= t)
+                p_array.resize(t + 1);
+            return p_array[t];
         }
         Value& operator[](const String& t) {
             if (p_type != VALUE_OBJECT)
                 *this = Object();
-            return (*(Object*)p_data)[t];
+            p_detach();
+            return (*p_object)[t];
         }
 
         bool isNull() const {
@@ -141,57 +198,538 @@ class Value {
             return p_type == VALUE_STRING;
         }
         ValueType type() const {
-            return p_type;
+            return ValueType(p_type);
         }
 
         Array& array() {
             if (!isArray())
                 *this = Array();
-            return *(Array*)p_data;
+            p_detach();
+            return p_array;
         }
         Object& object() {
             if (!isObject())
                 *this = Object();
-            return *(Object*)p_data;
+            p_detach();
+            return *p_object;
+        }
+        // Empty if the value is of another type.
+        const Array& array() const {
+            static const Array none;
+            if (!isArray())
+                return none;
+            return p_shared ? p_target().p_array : p_array;
+        }
+        const Object& object() const {
+            static const Object none;
+            if (!isObject())
+                return none;
+            return p_shared ? *p_target().p_object : *p_object;
         }
         String& string() {
             if (!isString())
                 *this = String();
-            return *(String*)p_data;
+            return p_str();
         }
+        std::string_view view() const {
+            if (!isString())
+                return std::string_view();
+            switch (p_kind) {
+                case (KIND_VIEW):
+                    return p_view;
+                case (KIND_INTEGER):
+                case (KIND_REAL):
+                    return std::string_view(p_number.text, p_length);
+                case (KIND_BOOLEAN):
+                    return p_number.i ? "true" : "false";
+                default:
+                    return p_string;
+            }
+        }
+        // Numbers read from text like std::stoll and std::stod would (with 
+        // leading spaces and trailing characters ignored, and hexadecimal 
+        // reals such as 0x1A or 0x1p3), but without locale and exceptions: 
+        // text that is not a number in range gives 0.
         long long integer() const {
-            return isString() ? std::stoll(*(String*)p_data) : 0;
+            if (!isString())
+                return 0;
+            if (p_kind == KIND_INTEGER)
+                return p_number.i;
+            long long rtn = 0;
+            std::string_view s = p_trim(view());
+            if (std::from_chars(s.data(), s.data() + s.length(), rtn).ec != std::errc())
+                rtn = 0;
+            return rtn;
         }
         double real() const {
-            return isString() ? std::stod(*(String*)p_data) : 0.0;
+            if (!isString())
+                return 0.0;
+            if (p_kind == KIND_REAL)
+                return p_number.d;
+            if (p_kind == KIND_INTEGER)
+                return double(p_number.i);
+            double rtn = 0.0;
+            std::string_view s = p_trim(view());
+            // std::from_chars takes hexadecimal without its prefix.
+            bool minus = !s.empty() && s[0] == '-';
+            std::string_view h = s.substr(minus);
+            if (h.length() > 2 && h[0] == '0' && (h[1] == 'x' || h[1] == 'X') && h[2] != '-') {
+                if (std::from_chars(h.data() + 2, h.data() + h.length(), rtn, std::chars_format::hex).ec != std::errc())
+                    return 0.0;
+                return minus ? -rtn : rtn;
+            }
+            if (std::from_chars(s.data(), s.data() + s.length(), rtn).ec != std::errc())
+                rtn = 0.0;
+            return rtn;
         }
         bool boolean() const {
-            return isString() ? *(String*)p_data == "true" : false;
+            if (p_kind == KIND_BOOLEAN)
+                return isString() && p_number.i;
+            return isString() ? view() == "true" : false;
         }
 
     private:
-        ValueType p_type;
-        void* p_data;
+        // How a string is held.
+        using Kind = enum {
+            KIND_TEXT,
+            KIND_VIEW,
+            KIND_INTEGER,
+            KIND_REAL,
+            KIND_BOOLEAN
+        };
+        struct Shared;
 
-        void p_clear() {
-            switch (p_type) {
+        // Takes results apart to build the next ones, see Reader::recycle().
+        friend class Builder;
+
+        // The text of a number is formatted when it is set, the shortest 
+        // that reads back as the same number.
+        struct Number {
+            union {
+                long long i;
+                double d;
+            };
+            char text[24];
+        };
+
+        union {
+            String p_string;
+            std::string_view p_view;
+            Number p_number;
+            Array p_array;
+            Object* p_object;
+            Shared* p_node;
+        };
+        unsigned char p_type = VALUE_NULL;
+        bool p_arena = false;
+        bool p_shared = false;
+        unsigned char p_kind = KIND_TEXT;
+        // Length of the text of a number.
+        unsigned char p_length = 0;
+
+        // A string of t, copied into the arena if it does not fit in the 
+        // buffer of a String.
+        static Value p_inArena(std::string_view t, Arena& a) {
+            static const size_t small = String().capacity();
+            if (t.length() <= small)
+                return Value(String(t));
+            char* p = (char*)a.allocate(t.length(), 1);
+            memcpy(p, t.data(), t.length());
+            Value rtn;
+            rtn.p_view = std::string_view(p, t.length());
+            rtn.p_type = VALUE_STRING;
+            rtn.p_kind = KIND_VIEW;
+            return rtn;
+        }
+        // Whether the storage of this array or object is in an arena.
+        bool p_inArena() const {
+            if (p_type == VALUE_ARRAY)
+                return !p_shared && p_array.get_allocator().arena() != nullptr;
+            if (p_type == VALUE_OBJECT)
+                return !p_shared && (p_arena || p_object->get_allocator().arena() != nullptr);
+            return false;
+        }
+
+        // Turns any string into a String.
+        String& p_str() {
+            if (p_kind == KIND_TEXT)
+                return p_string;
+            String s(view());
+            new (&p_string) String(std::move(s));
+            p_kind = KIND_TEXT;
+            p_length = 0;
+            return p_string;
+        }
+        void p_format() {
+            std::to_chars_result r;
+            if (p_kind == KIND_INTEGER)
+                r = std::to_chars(p_number.text, p_number.text + sizeof(p_number.text), p_number.i);
+            else 
+                r = std::to_chars(p_number.text, p_number.text + sizeof(p_number.text), p_number.d);
+            p_length = (unsigned char)(r.ptr - p_number.text);
+        }
+        // std::from_chars takes neither leading spaces nor a '+'.
+        static std::string_view p_trim(std::string_view s) {
+            size_t i = 0;
+            while (i < s.length() && isspace((unsigned char)s[i]))
+                ++i;
+            if (i + 1 < s.length() && s[i] == '+' && s[i + 1] != '-')
+                ++i;
+            return s.substr(i);
+        }
+
+        const Value& p_target() const;
+        void p_retain();
+        void p_release();
+        void p_detach();
+
+        // Arrays and objects nested deeper than this in the value being 
+        // copied or destroyed are walked with a stack instead of recursing, 
+        // so that the depth of a value costs no more than so much of the 
+        // call stack.
+        static constexpr size_t p_nestMax = 64;
+
+        // The depth of the copies and destructions in progress on this 
+        // thread, counted by Nesting.
+        static size_t& p_nesting() {
+            static thread_local size_t n = 0;
+            return n;
+        }
+#ifdef SOL_ENABLE_STATS
+        static size_t& p_copies() {
+            static thread_local size_t n = 0;
+            return n;
+        }
+#endif
+        class Nesting {
+            public:
+                Nesting() {
+                    ++p_nesting();
+                }
+                Nesting(const Nesting&) = delete;
+                ~Nesting() {
+                    --p_nesting();
+                }
+
+                Nesting& operator=(const Nesting&) = delete;
+        };
+
+        // Whether this is an array or an object of its own.
+        bool p_isTree() const {
+            return !p_shared && (p_type == VALUE_ARRAY || p_type == VALUE_OBJECT);
+        }
+        template <class F>
+        void p_children(F f);
+
+        void p_copy(const Value& t) {
+            if (t.p_shared) {
+                p_node = t.p_node;
+                p_retain();
+                p_type = t.p_type;
+                p_shared = true;
+                p_arena = false;
+                return;
+            }
+            switch (t.p_type) {
+                case (VALUE_NULL):
+                    break;
+                case (VALUE_ARRAY):
+                case (VALUE_OBJECT): {
+                    if (p_nesting() < p_nestMax) {
+#ifdef SOL_ENABLE_STATS
+                        ++p_copies();
+#endif
+                        Nesting n;
+                        if (t.p_type == VALUE_ARRAY)
+                            new (&p_array) Array(t.p_array);
+                        else 
+                            p_object = new Object(*t.p_object);
+                        break;
+                    }
+                    // Trees are first copied as nulls and filled in from the 
+                    // list of those pending, one level at a time.
+                    std::vector<std::pair<Value*, const Value*>> pending;
+                    Value v;
+                    v.p_copyLevel(t, pending);
+                    while (!pending.empty()) {
+                        auto i = pending.back();
+                        pending.pop_back();
+                        i.first->p_copyLevel(*i.second, pending);
+                    }
+                    p_move(v);
+                    return;
+                }
+                case (VALUE_STRING):
+                    if (t.p_kind == KIND_TEXT) {
+                        new (&p_string) String(t.p_string);
+                        break;
+                    }
+                    if (t.p_kind == KIND_VIEW) {
+                        new (&p_string) String(t.p_view);
+                        break;
+                    }
+                    p_number = t.p_number;
+                    p_kind = t.p_kind;
+                    p_length = t.p_length;
+                    break;
+            }
+            p_type = t.p_type;
+            p_arena = false;
+        }
+        // Copies the array or object t into this null value, except for the 
+        // trees in it which are added to pending.
+        void p_copyLevel(const Value& t, std::vector<std::pair<Value*, const Value*>>& pending) {
+#ifdef SOL_ENABLE_STATS
+            ++p_copies();
+#endif
+            bool nested = false;
+            if (t.p_type == VALUE_ARRAY) {
+                for (const Value& i : t.p_array)
+                    nested = nested || i.p_isTree();
+                if (!nested)
+                    new (&p_array) Array(t.p_array);
+                else {
+                    new (&p_array) Array();
+                    p_type = VALUE_ARRAY;
+                    p_array.reserve(t.p_array.size());
+                    for (const Value& i : t.p_array) {
+                        if (!i.p_isTree())
+                            p_array.emplace_back(i);
+                        else {
+                            p_array.emplace_back();
+                            pending.emplace_back(&p_array.back(), &i);
+                        }
+                    }
+                }
+            }
+            else {
+                for (auto& i : *t.p_object)
+                    nested = nested || i.second.p_isTree();
+                if (!nested)
+                    p_object = new Object(*t.p_object);
+                else {
+#ifdef SOL_FLAT_OBJECT
+                    p_object = new Object();
+                    p_object->reserve(t.p_object->size());
+#else
+                    p_object = new Object(t.p_object->bucket_count());
+#endif
+                    p_type = VALUE_OBJECT;
+                    auto add = [&](const Object::value_type& i) {
+                        if (!i.second.p_isTree())
+                            p_object->emplace(i.first, i.second);
+                        else 
+                            pending.emplace_back(&p_object->emplace(i.first, Value()).first->second, &i.second);
+                    };
+#ifdef SOL_FLAT_OBJECT
+                    for (auto& i : *t.p_object)
+                        add(i);
+#else
+                    // Inserted backwards into as many buckets, the members 
+                    // keep the order of the copied map, as with its copy 
+                    // constructor.
+                    std::vector<const Object::value_type*> members;
+                    for (auto& i : *t.p_object)
+                        members.push_back(&i);
+                    for (auto i = members.rbegin(); i != members.rend(); ++i)
+                        add(**i);
+#endif
+                }
+            }
+            p_type = t.p_type;
+        }
+        void p_move(Value& t) {
+            p_type = t.p_type;
+            p_arena = t.p_arena;
+            p_shared = t.p_shared;
+            p_kind = t.p_kind;
+            p_length = t.p_length;
+            if (p_shared)
+                p_node = t.p_node;
+            else switch (t.p_type) {
                 case (VALUE_NULL):
                     break;
                 case (VALUE_ARRAY):
-                    delete (Array*)p_data;
+                    new (&p_array) Array(std::move(t.p_array));
+                    t.p_array.~Array();
                     break;
                 case (VALUE_OBJECT):
-                    delete (Object*)p_data;
+                    p_object = t.p_object;
                     break;
                 case (VALUE_STRING):
-                    delete (String*)p_data;
+                    if (t.p_kind == KIND_VIEW)
+                        p_view = t.p_view;
+                    else if (t.p_kind != KIND_TEXT)
+                        p_number = t.p_number;
+                    else {
+                        new (&p_string) String(std::move(t.p_string));
+                        t.p_string.~String();
+                    }
+                    break;
+            }
+            t.p_type = VALUE_NULL;
+            t.p_arena = t.p_shared = false;
+            t.p_kind = KIND_TEXT;
+            t.p_length = 0;
+        }
+        void p_unnest();
+        void p_clear() {
+            if (p_shared)
+                p_release();
+            else switch (p_type) {
+                case (VALUE_NULL):
+                    break;
+                case (VALUE_ARRAY): {
+                    if (p_nesting() >= p_nestMax)
+                        p_unnest();
+                    Nesting n;
+                    p_array.~Array();
+                    break;
+                }
+                case (VALUE_OBJECT): {
+                    if (p_nesting() >= p_nestMax)
+                        p_unnest();
+                    Nesting n;
+                    if (p_arena)
+                        p_object->~Object();
+                    else 
+                        delete p_object;
+                    break;
+                }
+                case (VALUE_STRING):
+                    if (p_kind == KIND_TEXT)
+                        p_string.~String();
                     break;
             }
             p_type = VALUE_NULL;
-            p_data = nullptr;
+            p_arena = p_shared = false;
+            p_kind = KIND_TEXT;
+            p_length = 0;
         }
 };
 
+// Moves are what lets a growing Array relocate its elements instead of 
+// copying every tree in them.
+static_assert(std::is_nothrow_move_constructible<Value>::value && std::is_nothrow_move_assignable<Value>::value, "Value moves must not throw");
+
+struct Value::Shared {
+    std::atomic<size_t> refs{1};
+    Value value;
+};
+
+// The elements or members of a container, through its node if it 
+// is shared.
+template <class F>
+inline void Value::p_children(F f) {
+    Value& v = p_shared ? p_node->value : *this;
+    if (v.p_type == VALUE_ARRAY) {
+        for (Value& i : v.p_array)
+            f(i);
+    }
+    else if (v.p_type == VALUE_OBJECT) {
+        for (auto& i : *v.p_object)
+            f(i.second);
+    }
+}
+// Destroys the arrays and objects in this one, deepest first, so that 
+// destroying it recurses no further. A shared one counts when this holds 
+// its last reference. The stack holds those whose children are to be 
+// destroyed before them.
+inline void Value::p_unnest() {
+    auto nested = [](Value& v) {
+        if (v.p_shared)
+            return v.p_node->refs.load(std::memory_order_acquire) == 1;
+        return (v.p_type == VALUE_ARRAY && !v.p_array.empty()) || (v.p_type == VALUE_OBJECT && !v.p_object->empty());
+    };
+    std::vector<Value*> stack;
+    p_children([&](Value& i) {
+        if (nested(i))
+            stack.push_back(&i);
+    });
+    while (!stack.empty()) {
+        Value* v = stack.back();
+        size_t n = stack.size();
+        v->p_children([&](Value& i) {
+            if (nested(i))
+                stack.push_back(&i);
+        });
+        if (stack.size() == n) {
+            stack.pop_back();
+            v->p_clear();
+        }
+    }
+}
+
+inline Value& Value::share() {
+    std::vector<Value*> stack{this};
+    while (!stack.empty()) {
+        Value& v = *stack.back();
+        stack.pop_back();
+        if (v.p_shared)
+            continue;
+        switch (v.p_type) {
+            case (VALUE_NULL):
+                continue;
+            case (VALUE_ARRAY):
+                if (v.p_inArena())
+                    v.p_array = Array(std::move(v.p_array), ArenaAllocator<Value>());
+                break;
+            case (VALUE_OBJECT):
+                if (v.p_inArena()) {
+                    Object* o = new Object(std::move(*v.p_object), Object::allocator_type());
+                    if (v.p_arena)
+                        v.p_object->~Object();
+                    else 
+                        delete v.p_object;
+                    v.p_object = o;
+                    v.p_arena = false;
+                }
+                break;
+            case (VALUE_STRING):
+                if (v.p_kind == KIND_VIEW)
+                    v.p_str();
+                continue;
+        }
+        // The children keep their place when the container is moved into 
+        // its node.
+        v.p_children([&](Value& i) {
+            stack.push_back(&i);
+        });
+        Shared* n = new Shared;
+        n->value.p_move(v);
+        v.p_node = n;
+        v.p_type = n->value.p_type;
+        v.p_shared = true;
+    }
+    return *this;
+}
+
+inline const Value& Value::p_target() const {
+    return p_node->value;
+}
+inline void Value::p_retain() {
+    p_node->refs.fetch_add(1, std::memory_order_relaxed);
+}
+inline void Value::p_release() {
+    if (p_node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete p_node;
+}
+// Gives this value a node of its own to change.
+inline void Value::p_detach() {
+    if (!p_shared)
+        return;
+    Shared* n = p_node;
+    Value v;
+    if (n->refs.load(std::memory_order_acquire) == 1)
+        v.p_move(n->value);
+    else 
+        v.p_copy(n->value);
+    p_release();
+    p_shared = false;
+    p_type = VALUE_NULL;
+    p_move(v);
+}
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,283 @@
+#ifndef SOL_WRITER_HPP_INCLUDED
+#define SOL_WRITER_HPP_INCLUDED
+
+#include <cstdio>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SOL_Sink.hpp"
+#include "SOL_Simd.hpp"
+#include "SOL_Stats.hpp"
+#include "SOL_Value.hpp"
+
+namespace sol {
+namespace internal {
+
+// What the writer does with each byte at which findEscapeStop() stops: 
+// the letter of its escape, the length (2 or 3) of the character it starts 
+// for a \uXXXX escape, or 0 to leave it out (longer characters and bytes 
+// out of place).
+struct EscapeTable {
+    char what[256];
+
+    constexpr EscapeTable(): what() {
+        what[(unsigned char)'\t'] = 't';
+        what[(unsigned char)'\n'] = 'n';
+        what[(unsigned char)'\r'] = 'r';
+        what[(unsigned char)'"'] = '"';
+        what[(unsigned char)'\\'] = '\\';
+        for (int c = 0xC0; c < 0xE0; ++c)
+            what[c] = 2;
+        for (int c = 0xE0; c < 0xF0; ++c)
+            what[c] = 3;
+    }
+};
+
+inline constexpr EscapeTable escapes{};
+
+}
+
+// Formats a Value as SOL text. Options and errors belong to the writer, 
+// so different writers can be used from different threads at the same 
+// time.
+class Writer {
+    public:
+        Writer() = default;
+        Writer(const Writer&) = delete;
+        ~Writer() = default;
+
+        Writer& operator=(const Writer&) = delete;
+
+        const std::string& error() const {
+            return p_error;
+        }
+
+        void outputEscapeUnicode(bool b) {
+            p_escapeUnicode = b;
+        }
+#ifdef SOL_ENABLE_STATS
+        // Add up what the following outputs do in s, nullptr (initially) 
+        // to stop. Escapes count the strings which needed any, the 
+        // allocations and scanning fields are left alone.
+        void stats(Stats* s) {
+            p_stats = s;
+        }
+#endif
+
+        bool toFile(const std::string& path, const Value& v) {
+            return p_toFile(path, v, false, 0, 0);
+        }
+        std::string toString(const Value& v) const {
+            std::string rtn;
+            StringSink out(rtn);
+            std::vector<Frame> stack;
+            p_output(out, v, false, 0, 0, stack);
+            return rtn;
+        }
+        bool write(Sink& out, const Value& v) {
+            return p_check(p_output(out, v, false, 0, 0, p_stack));
+        }
+
+        bool toFile(const std::string& path, const Value& v, size_t n, size_t off = 0) {
+            return p_toFile(path, v, true, n, off);
+        }
+        std::string toString(const Value& v, size_t n, size_t off = 0) const {
+            std::string rtn;
+            StringSink out(rtn);
+            std::vector<Frame> stack;
+            p_output(out, v, true, n, off, stack);
+            return rtn;
+        }
+        bool write(Sink& out, const Value& v, size_t n, size_t off = 0) {
+            return p_check(p_output(out, v, true, n, off, p_stack));
+        }
+
+        // Writes s as a quoted value, escaped the same way as the values 
+        // written above.
+        void writeString(Sink& out, std::string_view s) const {
+#ifdef SOL_ENABLE_STATS
+            if (p_stats != nullptr)
+                p_countString(s);
+#endif
+            out.put('"');
+            p_escape(out, s);
+            out.put('"');
+        }
+
+    private:
+        // An array or object being written, with its next and past the 
+        // last elements or members.
+        struct Frame {
+            bool object;
+            bool first;
+            const Value* element;
+            const Value* end;
+            Object::const_iterator member;
+            Object::const_iterator last;
+        };
+
+        bool p_escapeUnicode = false;
+        std::string p_error;
+        // Kept for the following outputs by the functions which are not 
+        // const, toString() stays safe to call from several threads.
+        std::vector<Frame> p_stack;
+#ifdef SOL_ENABLE_STATS
+        Stats* p_stats = nullptr;
+
+        void p_countString(std::string_view s) const {
+            if (internal::findEscapeStop(s.data(), s.data() + s.length(), p_escapeUnicode) != s.data() + s.length())
+                ++p_stats->escapes;
+        }
+#endif
+
+    private:
+        bool p_check(bool ok) {
+            if (!ok)
+                p_error = "Incomplete output";
+            return ok;
+        }
+        bool p_toFile(const std::string& path, const Value& v, bool pretty, size_t n, size_t off) {
+            FILE* fout = fopen(path.c_str(), "w");
+            if (fout == nullptr) {
+                p_error = "Fail to create file";
+                return false;
+            }
+            bool rtn;
+            {
+                FileSink out(fout);
+                rtn = pretty ? write(out, v, n, off) : write(out, v);
+            }
+            fclose(fout);
+            return rtn;
+        }
+
+        // Writes v and flushes, returns false if any output has failed.
+        bool p_output(Sink& out, const Value& v, bool pretty, size_t n, size_t off, std::vector<Frame>& stack) const {
+#ifdef SOL_ENABLE_STATS
+            if (p_stats != nullptr) {
+                internal::StatsTimer timer(p_stats, &Stats::seconds);
+                size_t start = out.written(), copies = Value::copies();
+                p_tree(out, v, pretty, n, off, stack);
+                bool rtn = out.flush();
+                p_stats->bytes += out.written() - start;
+                p_stats->copies += Value::copies() - copies;
+                return rtn;
+            }
+#endif
+            p_tree(out, v, pretty, n, off, stack);
+            return out.flush();
+        }
+
+        // Writes v, pretty printed or not, with a stack of the arrays and 
+        // objects being written (innermost last) in place of recursion.
+        void p_tree(Sink& out, const Value& v, bool pretty, size_t n, size_t off, std::vector<Frame>& stack) const {
+            stack.clear();
+            const Value* cur = &v;
+            while (cur != nullptr) {
+#ifdef SOL_ENABLE_STATS
+                if (p_stats != nullptr)
+                    ++p_stats->nodes;
+#endif
+                if (cur->isArray()) {
+                    if (pretty)
+                        out.write("[\n", 2);
+                    else 
+                        out.put('[');
+                    const Array& a = cur->array();
+                    stack.push_back({false, true, a.data(), a.data() + a.size(), {}, {}});
+#ifdef SOL_ENABLE_STATS
+                    if (p_stats != nullptr && stack.size() > p_stats->maxDepth)
+                        p_stats->maxDepth = stack.size();
+#endif
+                }
+                else if (cur->isObject()) {
+                    if (pretty)
+                        out.write("{\n", 2);
+                    else 
+                        out.put('{');
+                    const Object& o = cur->object();
+                    stack.push_back({true, true, nullptr, nullptr, o.begin(), o.end()});
+#ifdef SOL_ENABLE_STATS
+                    if (p_stats != nullptr && stack.size() > p_stats->maxDepth)
+                        p_stats->maxDepth = stack.size();
+#endif
+                }
+                else if (cur->isString())
+                    writeString(out, cur->view());
+                cur = nullptr;
+                // Moves on to the next element or member, closing the 
+                // arrays and objects which have none left.
+                while (!stack.empty()) {
+                    Frame& f = stack.back();
+                    if (f.object ? f.member != f.last : f.element != f.end) {
+                        if (pretty) {
+                            if (!f.first)
+                                out.write(",\n", 2);
+                            out.fill(' ', off + n * stack.size());
+                        }
+                        else if (!f.first)
+                            out.put(',');
+                        f.first = false;
+                        if (f.object) {
+                            out.write(f.member->first.data(), f.member->first.length());
+                            if (pretty)
+                                out.write(" = ", 3);
+                            else 
+                                out.put('=');
+                            cur = &(f.member++)->second;
+                        }
+                        else 
+                            cur = f.element++;
+                        break;
+                    }
+                    if (pretty) {
+                        out.put('\n');
+                        out.fill(' ', off + n * (stack.size() - 1));
+                    }
+                    out.put(f.object ? '}' : ']');
+                    stack.pop_back();
+                }
+            }
+        }
+
+        void p_escape(Sink& out, std::string_view s) const {
+            static const char* const hex = "0123456789ABCDEF";
+            const char* p = s.data();
+            const char* end = p + s.length();
+            while (true) {
+                const char* q = internal::findEscapeStop(p, end, p_escapeUnicode);
+                if (q != p)
+                    out.write(p, q - p);
+                if (q == end)
+                    return;
+                unsigned char c = *q;
+                char e = internal::escapes.what[c];
+                if (e > 3) {
+                    const char x[2] = {'\\', e};
+                    out.write(x, 2);
+                    p = q + 1;
+                }
+                else if (e == 0)
+                    p = q + 1;
+                else {
+                    // A character cut by the end of the string ends it.
+                    if (end - q < e)
+                        return;
+                    unsigned int u;
+                    if (e == 2)
+                        u = (c & 0x1F) << 6 | (q[1] & 0x3F);
+                    else 
+                        u = (c & 0xF) << 12 | (q[1] & 0x3F) << 6 | (q[2] & 0x3F);
+                    const char x[6] = {'\\', 'u', hex[u >> 12], hex[(u >> 8) & 0xF], hex[(u >> 4) & 0xF], hex[u & 0xF]};
+                    out.write(x, 6);
+                    p = q + e;
+                }
+            }
+        }
+};
+
+}
+
+#endif
\ No newline at end of file
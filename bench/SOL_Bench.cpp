@@ -0,0 +1,489 @@
+// Benchmarks of SOL on generated corpora, see "Benchmark" in README.md.
+// Every result is printed as one JSON object per line.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#include "../SOL.hpp"
+
+// Every allocation of the program goes through here to be counted. GCC 
+// takes the free() of the replaced operator delete for a mismatch.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static std::atomic<size_t> allocCount{0};
+static std::atomic<size_t> allocBytes{0};
+
+void* operator new(size_t n) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(n, std::memory_order_relaxed);
+    if (void* p = malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) {
+    return operator new(n);
+}
+void operator delete(void* p) noexcept {
+    free(p);
+}
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+namespace {
+
+// Small generator with the same sequence on every platform, unlike the
+// distributions of <random>.
+class Random {
+    public:
+        Random(uint64_t seed): p_state(seed) {}
+
+        uint64_t next() {
+            uint64_t z = (p_state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+        size_t below(size_t n) {
+            return size_t(next() % n);
+        }
+
+    private:
+        uint64_t p_state;
+};
+
+// Appends the text of one top-level element of a corpus.
+using Shape = std::function<void(Random&, std::string&)>;
+
+const char* const letters = "abcdefghijklmnopqrstuvwxyz0123456789 ";
+
+void word(Random& r, std::string& s, size_t len) {
+    for (size_t i = 0; i < len; ++i)
+        s += letters[r.below(37)];
+}
+
+struct Corpus {
+    const char* name;
+    Shape shape;
+};
+
+const std::vector<Corpus>& corpora() {
+    static const std::vector<Corpus> rtn = {
+        // Records as most documents hold them.
+        {"records", [](Random& r, std::string& s) {
+            s += "{id = \"";
+            s += std::to_string(r.below(1000000));
+            s += "\", name = \"";
+            word(r, s, 4 + r.below(28));
+            s += "\", tags = [\"";
+            word(r, s, 1 + r.below(8));
+            s += "\", \"";
+            word(r, s, 1 + r.below(8));
+            s += "\"], sub = {k = \"v\", price = \"";
+            s += std::to_string(r.below(100000) / 100.0);
+            s += "\"}}";
+        }},
+        // Objects of 64 members.
+        {"wide", [](Random& r, std::string& s) {
+            s += '{';
+            for (int i = 0; i < 64; ++i) {
+                if (i)
+                    s += ',';
+                s += "field_";
+                s += std::to_string(i);
+                s += "=\"";
+                word(r, s, 1 + r.below(12));
+                s += '"';
+            }
+            s += '}';
+        }},
+        // Chains of 32 nested objects and arrays.
+        {"deep", [](Random& r, std::string& s) {
+            for (int i = 0; i < 16; ++i)
+                s += "{a=[";
+            s += '"';
+            word(r, s, 8);
+            s += '"';
+            for (int i = 0; i < 16; ++i)
+                s += "]}";
+        }},
+        // Strings of 4 to 64 KiB.
+        {"longstr", [](Random& r, std::string& s) {
+            s += '"';
+            word(r, s, 4096 + r.below(60 * 1024));
+            s += '"';
+        }},
+        // Strings that are mostly escapes.
+        {"escape", [](Random& r, std::string& s) {
+            static const char* const escapes[] = {"\\\"", "\\\\", "\\n", "\\t", "\\r", "\\u00E9", "\\u4E2D"};
+            s += '"';
+            for (size_t i = 0, n = 16 + r.below(240); i < n; ++i) {
+                if (r.below(2))
+                    s += escapes[r.below(7)];
+                else
+                    s += letters[r.below(37)];
+            }
+            s += '"';
+        }},
+        // Strings of two and three byte UTF-8 characters.
+        {"unicode", [](Random& r, std::string& s) {
+            static const char* const chars[] = {"\xC3\xA9", "\xD0\x96", "\xE4\xB8\xAD", "\xE3\x81\x82", "a"};
+            s += '"';
+            for (size_t i = 0, n = 16 + r.below(240); i < n; ++i)
+                s += chars[r.below(5)];
+            s += '"';
+        }},
+        // Short values only.
+        {"array", [](Random& r, std::string& s) {
+            s += '"';
+            s += std::to_string(r.below(100000));
+            s += '"';
+        }},
+    };
+    return rtn;
+}
+
+// A top-level array of elements of the shape, about size bytes long.
+std::string generate(const Shape& shape, size_t size, uint64_t seed) {
+    Random r(seed);
+    std::string rtn = "[\n";
+    while (rtn.length() < size) {
+        shape(r, rtn);
+        rtn += ",\n";
+    }
+    rtn += "]\n";
+    return rtn;
+}
+
+// Up to n paths of values in v, for sol::check.
+void paths(const sol::Value& v, const std::string& prefix, std::vector<std::string>& ls, size_t n) {
+    if (ls.size() >= n)
+        return;
+    if (!prefix.empty())
+        ls.push_back(prefix);
+    std::string p = prefix.empty() ? prefix : prefix + ".";
+    if (v.isArray()) {
+        const sol::Array& a = v.array();
+        for (size_t i = 0; i < a.size() && ls.size() < n; i += 1 + a.size() / 8)
+            paths(a[i], p + std::to_string(i), ls, n);
+    }
+    else if (v.isObject()) {
+        for (auto& i : v.object())
+            paths(i.second, p + i.first, ls, n);
+    }
+}
+
+struct Options {
+    size_t size = 8 << 20;
+    size_t reps = 5;
+    uint64_t seed = 1;
+    std::string only;
+    std::string dir = ".";
+    bool threads = false;
+};
+
+// Whether every measure has succeeded, for the exit status.
+bool passed = true;
+
+// Runs f reps times and prints the best time, allocations (and with 
+// stats, deep copies) are counted on the last run.
+void measure(const Options& opt, const char* corpus, const char* op, size_t bytes, size_t ops, const std::function<bool()>& f) {
+    double best = 1e100;
+    size_t count = 0, total = 0, copies = 0;
+    bool ok = true;
+    for (size_t i = 0; i < opt.reps; ++i) {
+        size_t c = allocCount.load(), b = allocBytes.load();
+#ifdef SOL_ENABLE_STATS
+        size_t d = sol::Value::copies();
+#endif
+        auto t0 = std::chrono::steady_clock::now();
+        ok = f() && ok;
+        auto t1 = std::chrono::steady_clock::now();
+        count = allocCount.load() - c;
+        total = allocBytes.load() - b;
+#ifdef SOL_ENABLE_STATS
+        copies = sol::Value::copies() - d;
+#endif
+        best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+    }
+    printf("{\"corpus\":\"%s\",\"op\":\"%s\",\"ok\":%s,\"bytes\":%zu,\"seconds\":%.6f,\"mb_s\":%.2f,\"ns_op\":%.1f,\"allocs\":%zu,\"alloc_bytes\":%zu",
+        corpus, op, ok ? "true" : "false", bytes, best, bytes / best / 1e6, best * 1e9 / ops, count, total);
+#ifdef SOL_ENABLE_STATS
+    printf(",\"copies\":%zu", copies);
+#else
+    (void)copies;
+#endif
+    printf("}\n");
+    fflush(stdout);
+    passed = passed && ok;
+}
+
+#ifdef SOL_ENABLE_STATS
+// Prints the stats of one parse and one output of the corpus, next to the
+// allocations actually made.
+void stats(const char* corpus, const std::string& text) {
+    sol::Reader reader;
+    sol::Writer writer;
+    sol::Stats in, out;
+    reader.stats(&in);
+    writer.stats(&out);
+    size_t c = allocCount.load();
+    reader.fromString(text);
+    size_t count = allocCount.load() - c;
+    writer.toString(reader.result());
+    static const char* const names[] = {"eof", "error", "lcbracket", "lsbracket", "rcbracket", "rsbracket", "equal", "comma", "key", "value"};
+    printf("{\"corpus\":\"%s\",\"op\":\"stats\",\"bytes\":%zu,\"max_depth\":%zu,\"unescaped\":%zu,\"nodes\":%zu,\"allocations\":%zu,\"allocs\":%zu,\"copies\":%zu,\"seconds\":%.6f,\"scan_seconds\":%.6f,\"tokens\":{",
+        corpus, in.bytes, in.maxDepth, in.escapes, in.nodes, in.allocations, count, in.copies, in.seconds, in.scanSeconds);
+    for (size_t i = 0; i <= sol::internal::TOKEN_VALUE; ++i)
+        printf("%s\"%s\":%zu", i ? "," : "", names[i], in.tokens[i]);
+    printf("},\"written\":%zu,\"escaped\":%zu,\"write_seconds\":%.6f}\n", out.bytes, out.escapes, out.seconds);
+    fflush(stdout);
+}
+#endif
+
+void run(const Options& opt, const Corpus& c) {
+    std::string text = generate(c.shape, opt.size, opt.seed);
+    std::string path = opt.dir + "/sol_bench_" + c.name + ".sol";
+    std::string out = opt.dir + "/sol_bench_out.sol";
+    FILE* f = fopen(path.c_str(), "wb");
+    if (f == nullptr || fwrite(text.data(), 1, text.length(), f) != text.length()) {
+        fprintf(stderr, "Cannot write %s\n", path.c_str());
+        exit(1);
+    }
+    fclose(f);
+
+#ifdef SOL_ENABLE_STATS
+    stats(c.name, text);
+#endif
+    sol::Reader reader;
+    sol::Writer writer;
+    measure(opt, c.name, "fromString", text.length(), 1, [&]() {
+        return reader.fromString(text);
+    });
+    measure(opt, c.name, "fromFile", text.length(), 1, [&]() {
+        return reader.fromFile(path);
+    });
+    // The same parse on 1 to as many threads as the machine has, see 
+    // Reader::threads().
+    if (opt.threads) {
+        size_t n = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t k = 1; k <= n; ++k) {
+            sol::Reader r;
+            r.threads(k);
+            std::string op = "threads" + std::to_string(k);
+            measure(opt, c.name, op.c_str(), text.length(), 1, [&]() {
+                return r.fromString(text);
+            });
+        }
+    }
+    // A parse by a new reader and the destruction of its result, on the 
+    // heap and in an arena released along with it.
+    measure(opt, c.name, "parseHeap", text.length(), 1, [&]() {
+        sol::Reader r;
+        return r.fromString(text);
+    });
+    measure(opt, c.name, "parseArena", text.length(), 1, [&]() {
+        sol::Arena arena;
+        sol::Reader r;
+        r.arena(&arena);
+        return r.fromString(text);
+    });
+    sol::Value v = reader.takeResult();
+    std::string compact = writer.toString(v);
+    std::string indented = writer.toString(v, 4);
+    measure(opt, c.name, "toString", compact.length(), 1, [&]() {
+        return writer.toString(v).length() == compact.length();
+    });
+    measure(opt, c.name, "toStringIndented", indented.length(), 1, [&]() {
+        return writer.toString(v, 4).length() == indented.length();
+    });
+    measure(opt, c.name, "toFile", compact.length(), 1, [&]() {
+        return writer.toFile(out, v);
+    });
+    measure(opt, c.name, "toFileIndented", indented.length(), 1, [&]() {
+        return writer.toFile(out, v, 4);
+    });
+    remove(out.c_str());
+
+    // The binary encoding of the result (see sol::Binary), whose size is 
+    // the bytes of its lines: written, read back into a Value, and read 
+    // in place by visiting every node of a BinaryView.
+    std::string binary = sol::Binary::encode(v);
+    measure(opt, c.name, "binaryEncode", binary.length(), 1, [&]() {
+        return sol::Binary::encode(v).length() == binary.length();
+    });
+    measure(opt, c.name, "binaryDecode", binary.length(), 1, [&]() {
+        sol::Value w;
+        return sol::Binary::decode(binary, w);
+    });
+    measure(opt, c.name, "binaryView", binary.length(), 1, [&]() {
+        size_t n = 0;
+        std::vector<sol::BinaryView> nodes{sol::BinaryView(binary)};
+        while (!nodes.empty()) {
+            sol::BinaryView b = nodes.back();
+            nodes.pop_back();
+            n += b.view().length();
+            for (size_t i = 0; i < b.size(); ++i)
+                nodes.push_back(b.at(i));
+        }
+        return n != 0;
+    });
+
+    // Copies are made outside of the destroy measure and the other way
+    // around.
+    std::vector<sol::Value> copies(opt.reps);
+    size_t k = 0;
+    measure(opt, c.name, "copy", text.length(), 1, [&]() {
+        copies[k++] = v;
+        return true;
+    });
+    k = 0;
+    measure(opt, c.name, "destroy", text.length(), 1, [&]() {
+        copies[k++] = sol::Value();
+        return true;
+    });
+
+    // Each element alone in an array, as strings are no documents. Once 
+    // the first run has warmed the reader up, the following ones should 
+    // make no allocation.
+    std::vector<std::string> messages;
+    size_t size = 0;
+    for (const sol::Value& e : v.array()) {
+        messages.push_back(writer.toString(sol::Array(1, e)));
+        size += messages.back().length();
+    }
+    sol::Reader recycler;
+    recycler.recycle(true);
+    measure(opt, c.name, "messages", size, messages.size(), [&]() {
+        bool rtn = true;
+        for (const std::string& m : messages)
+            rtn = recycler.fromString(m) && rtn;
+        return rtn;
+    });
+
+    // The members of every object inserted into a new one (which is then 
+    // freed), looked up and iterated over: sol_bench_flat runs the same 
+    // with SOL_FLAT_OBJECT.
+    std::vector<const sol::Object*> objects;
+    size_t members = 0;
+    std::vector<const sol::Value*> stack{&v};
+    while (!stack.empty()) {
+        const sol::Value* cur = stack.back();
+        stack.pop_back();
+        if (cur->isArray()) {
+            for (const sol::Value& e : cur->array())
+                stack.push_back(&e);
+        }
+        else if (cur->isObject()) {
+            objects.push_back(&cur->object());
+            members += cur->object().size();
+            for (auto& i : cur->object())
+                stack.push_back(&i.second);
+        }
+    }
+    if (members != 0) {
+        measure(opt, c.name, "objectInsert", 0, members, [&]() {
+            size_t n = 0;
+            for (const sol::Object* o : objects) {
+                sol::Object t;
+                for (auto& i : *o)
+                    t[i.first] = sol::Value();
+                n += t.size();
+            }
+            return n == members;
+        });
+        measure(opt, c.name, "objectFind", 0, members, [&]() {
+            size_t n = 0;
+            for (const sol::Object* o : objects)
+                for (auto& i : *o)
+                    n += o->find(i.first) != o->end();
+            return n == members;
+        });
+        measure(opt, c.name, "objectIterate", 0, members, [&]() {
+            size_t n = 0;
+            for (const sol::Object* o : objects)
+                for (auto& i : *o)
+                    n += !i.second.isNull();
+            return n == members;
+        });
+    }
+
+    std::vector<std::string> ls;
+    paths(v, "", ls, 64);
+    static const char* const names[] = {":Null", ":Array", ":Object", ":String"};
+    std::vector<sol::ValueType> types;
+    std::vector<std::string> typed;
+    for (const std::string& p : ls) {
+        types.push_back(sol::Path(p).get(v)->type());
+        typed.push_back(p + names[types.back()]);
+    }
+    measure(opt, c.name, "check", 0, ls.size(), [&]() {
+        bool rtn = true;
+        for (size_t i = 0; i < ls.size(); ++i)
+            rtn = sol::check(v, ls[i], types[i]) && rtn;
+        return rtn;
+    });
+    measure(opt, c.name, "checkList", 0, 1, [&]() {
+        return sol::check(v, typed).back() == 0;
+    });
+    remove(path.c_str());
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        const char* val = i + 1 < argc ? argv[i + 1] : "";
+        if (a == "--size")
+            opt.size = size_t(atof(val) * (1 << 20));
+        else if (a == "--reps")
+            opt.reps = std::max(1, atoi(val));
+        else if (a == "--seed")
+            opt.seed = strtoull(val, nullptr, 10);
+        else if (a == "--corpus")
+            opt.only = val;
+        else if (a == "--dir")
+            opt.dir = val;
+        else if (a == "--threads") {
+            opt.threads = true;
+            continue;
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--size MiB] [--reps n] [--seed n] [--corpus name] [--dir path] [--threads]\n", argv[0]);
+            return a == "--help" ? 0 : 1;
+        }
+        ++i;
+    }
+    std::vector<const Corpus*> ls;
+    for (const Corpus& c : corpora())
+        if (opt.only.empty() || opt.only == c.name)
+            ls.push_back(&c);
+    if (ls.empty()) {
+        fprintf(stderr, "Unknown corpus %s\n", opt.only.c_str());
+        return 1;
+    }
+    printf("{\"version\":\"%s\",\"size\":%zu,\"reps\":%zu,\"seed\":%llu}\n", SOL_VERSION, opt.size, opt.reps, (unsigned long long)opt.seed);
+    for (const Corpus* c : ls)
+        run(opt, *c);
+    return passed ? 0 : 1;
+}
\ No newline at end of file
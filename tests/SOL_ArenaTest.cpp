@@ -0,0 +1,112 @@
+// Results built in an arena (see Reader::arena()): the same as those built
+// on the heap, without any allocation from the heap once the reader has
+// warmed up, and copies, shared values and moved containers which outlive
+// the arena where they have to.
+
+#define SOL_TEST_ALLOCATIONS
+
+#include <string>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+// Records with long strings, escaped ones, objects large enough to be
+// indexed and nested arrays. Keys are short, the ones longer than the
+// buffer of a String still come from the heap.
+std::string document() {
+    std::string s = "{list=[";
+    for (int i = 0; i < 500; ++i) {
+        s += "{id=\"" + std::to_string(i) + "\", name=\"a name long enough to be out of line " + std::to_string(i) + "\"";
+        s += ", text=\"tab\\tquote\\\"\\u00E9\\u4E2D and more to be long\", short=\"a\\tb\"";
+        s += ", tags=[\"a\", [\"b\", []], {}], m1=\"1\", m2=\"2\", m3=\"3\", m4=\"4\", m5=\"5\", m6=\"6\", m7=\"7\"},";
+    }
+    return s + "], count=\"500\"}";
+}
+
+std::string written(const sol::Value& v) {
+    return sol::Writer().toString(v);
+}
+
+}
+
+int main() {
+    const std::string text = document();
+    sol::Reader heap;
+    CHECK(heap.fromString(text));
+    const std::string expected = written(heap.result());
+
+    {
+        sol::Arena arena;
+        sol::Reader reader;
+        reader.arena(&arena);
+        CHECK(reader.fromString(text));
+        CHECK(written(reader.result()) == expected);
+        // Its stack and buffers grown, the reader only uses the arena.
+        size_t before = sol::test::allocations();
+        CHECK(reader.fromString(text));
+        size_t made = sol::test::allocations() - before;
+        if (!CHECK(made == 0))
+            fprintf(stderr, "  %zu allocations\n", made);
+        CHECK(written(reader.result()) == expected);
+        CHECK(arena.blocks() != 0);
+
+        // Copies and shared values come from the heap and outlive the
+        // arena, a value taken out does not.
+        sol::Value copy = reader.result();
+        sol::Value shared = reader.shareResult();
+        CHECK(reader.fromString(text));
+        sol::Value taken = reader.takeResult();
+        CHECK(written(taken) == expected);
+        // Growing a container of the arena takes more of it.
+        taken["list"].array().emplace_back(sol::String(100, 'x'));
+        taken["added"] = sol::String(100, 'y');
+        CHECK(taken["list"].array().size() == 501 && taken["added"].view() == std::string(100, 'y'));
+        taken = sol::Value();
+        reader.arena(nullptr);
+        CHECK(reader.fromString("[]"));
+        arena.release();
+        CHECK(written(copy) == expected);
+        CHECK(written(shared) == expected);
+    }
+
+    // Values built in an arena directly.
+    {
+        sol::Arena arena;
+        sol::Array a;
+        a.emplace_back(sol::String("an element"));
+        sol::Value v(std::move(a), arena);
+        CHECK(v.array().get_allocator().arena() == &arena && v.array()[0].view() == "an element");
+        sol::Value s(sol::String(100, 'z'), arena);
+        CHECK(s.view() == std::string(100, 'z'));
+        sol::Value o(sol::Object(), arena);
+        o["k"] = std::move(s);
+        CHECK(o.object().get_allocator().arena() == &arena && o["k"].view() == std::string(100, 'z'));
+        sol::Value c = o;
+        CHECK(c.object().get_allocator().arena() == nullptr);
+        o = sol::Value();
+        v = sol::Value();
+        arena.release();
+        CHECK(c["k"].view() == std::string(100, 'z'));
+    }
+
+    // Recycling next to an arena: what is kept from the heap is not put in
+    // the arena, nor the other way around.
+    {
+        sol::Arena arena;
+        sol::Reader reader;
+        reader.recycle(true);
+        for (int i = 0; i < 6; ++i) {
+            reader.arena(i % 2 ? &arena : nullptr);
+            CHECK(reader.fromString(text));
+            CHECK(written(reader.result()) == expected);
+        }
+        sol::PushReader push;
+        push.arena(&arena);
+        for (size_t i = 0; i < text.size(); i += 100)
+            CHECK(push.feed(text.data() + i, std::min<size_t>(100, text.size() - i)));
+        CHECK(push.finish() && written(push.result()) == expected);
+    }
+    return sol::test::result();
+}
\ No newline at end of file
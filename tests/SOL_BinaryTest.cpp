@@ -0,0 +1,135 @@
+// Binary encoding: round trips, the order of members, the widths of the
+// offset tables, and data which shares or overlaps nodes.
+
+#include <map>
+#include <string>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+// The text of v with members sorted by key, which an unordered_map does
+// not keep in the same order after a round trip.
+std::string written(const sol::Value& v) {
+    if (v.isArray()) {
+        std::string rtn = "[";
+        for (const sol::Value& e: v.array())
+            rtn += written(e) + ",";
+        return rtn + "]";
+    }
+    if (v.isObject()) {
+        std::map<std::string, const sol::Value*> members;
+        for (const auto& m: v.object())
+            members[m.first] = &m.second;
+        std::string rtn = "{";
+        for (const auto& m: members)
+            rtn += m.first + "=" + written(*m.second) + ",";
+        return rtn + "}";
+    }
+    return sol::Writer().toString(v);
+}
+
+// Tables of every width: the offsets of the last elements need 1, 2 and 4
+// bytes.
+const size_t counts[] = {0, 1, 40, 300, 70000};
+
+void testRoundTrips() {
+    sol::Reader reader;
+    for (size_t n: counts) {
+        std::string text = "{list=[";
+        for (size_t i = 0; i < n; ++i)
+            text += "{id=\"" + std::to_string(i) + "\", tags=[\"a\", \"b\"], e=[], o={}},";
+        text += "], name=\"\\u00E9\\t\", empty=\"\"}";
+        if (!CHECK(reader.fromString(text)))
+            continue;
+        std::string b = sol::Binary::encode(reader.result());
+        sol::Value v;
+        if (CHECK(sol::Binary::decode(b, v)))
+            CHECK(written(v) == written(reader.result()));
+        sol::BinaryView root(b);
+        CHECK(root["list"].size() == n);
+        if (n != 0)
+            CHECK(root["list"][n - 1]["id"].view() == std::to_string(n - 1));
+        CHECK(root["name"].view() == "\xC3\xA9\t");
+        CHECK(root["empty"].isString() && root["empty"].view().empty());
+        CHECK(!root["none"].valid());
+    }
+}
+
+// Members are stored in the order of the object, and found by key. Decoded
+// members come in the same order, which only shows with SOL_FLAT_OBJECT.
+void testMembers() {
+    sol::Value v;
+    const char* keys[] = {"m", "b", "zz", "a", "q", "c", "", "y"};
+    for (const char* k: keys)
+        v[k] = sol::String(k) + "!";
+    std::string b = sol::Binary::encode(v);
+    sol::BinaryView root(b);
+    size_t i = 0;
+    for (const auto& m: v.object()) {
+        CHECK(root[i].key() == m.first);
+        CHECK(root[i].view() == m.first + "!");
+        ++i;
+    }
+    for (const char* k: keys)
+        CHECK(root[k].view() == sol::String(k) + "!");
+    sol::Value w;
+    CHECK(sol::Binary::decode(b, w));
+#ifdef SOL_FLAT_OBJECT
+    i = 0;
+    for (const auto& m: w.object())
+        CHECK(root[i++].key() == m.first);
+#endif
+}
+
+// Data made by hand: "SOLB" and the nodes.
+std::string data(std::initializer_list<int> bytes) {
+    std::string rtn("SOLB");
+    for (int c: bytes)
+        rtn += char(c);
+    return rtn;
+}
+
+void testCorrupt() {
+    sol::Value v;
+    // Both elements are the same node.
+    CHECK(sol::Binary::decode(data({'A', 2, 1, 5, 5, 'N'}), v) == false);
+    CHECK(sol::Binary::decode(data({'A', 2, 1, 5, 6, 'N', 'N'}), v));
+    // Elements out of order.
+    CHECK(sol::Binary::decode(data({'A', 2, 1, 6, 5, 'N', 'N'}), v) == false);
+    // A key which is the value of its member.
+    CHECK(sol::Binary::decode(data({'O', 1, 1, 6, 6, 0, 'S', 0}), v) == false);
+    CHECK(sol::Binary::decode(data({'O', 1, 1, 6, 8, 0, 1, 'k', 'N'}), v));
+    // 64 arrays each holding the next twice, 2^64 nodes to decode if they
+    // were allowed to share it.
+    std::string chain("SOLB");
+    for (int i = 0; i < 64; ++i)
+        chain += std::string{'A', 2, 1, 5, 5};
+    chain += 'N';
+    CHECK(sol::Binary::decode(chain, v) == false);
+    // The view still reads it.
+    sol::BinaryView n(chain);
+    for (int i = 0; i < 64; ++i)
+        n = n[1];
+    CHECK(n.isNull());
+    // Bad widths, and varints past 32 bits.
+    CHECK(sol::Binary::decode(data({'A', 1, 3, 4, 'N'}), v) == false);
+    CHECK(sol::Binary::decode(data({'S', 0xFF, 0xFF, 0xFF, 0xFF, 0x7F}), v) == false);
+    // Every prefix of valid data is rejected.
+    sol::Value r;
+    r["k"] = sol::Array{sol::Value(sol::String("v")), sol::Value()};
+    std::string b = sol::Binary::encode(r);
+    for (size_t i = 0; i < b.size(); ++i)
+        CHECK(sol::Binary::decode(b.data(), i, v) == false);
+    CHECK(sol::Binary::decode(b, v));
+}
+
+}
+
+int main() {
+    testRoundTrips();
+    testMembers();
+    testCorrupt();
+    return sol::test::result();
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+// Structs bound with SOL_FIELDS: written by sol::write and read back by
+// sol::read they compare equal, the text is what a Reader reads as the
+// same members, and bad text fails with the error and position a Reader
+// gives or with the errors of its own.
+
+#include <cmath>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace test {
+
+struct Point {
+    int x = 0;
+    int y = 0;
+
+    bool operator==(const Point& t) const {
+        return x == t.x && y == t.y;
+    }
+};
+SOL_FIELDS(Point, x, y)
+
+struct Item {
+    std::string name;
+    bool active = false;
+    long long id = 0;
+    unsigned count = 0;
+    double price = 0;
+    float ratio = 0;
+    std::vector<std::string> tags;
+    std::vector<std::vector<int>> grid;
+    std::optional<double> discount;
+    std::optional<std::string> note;
+    Point at;
+    std::vector<Point> path;
+    std::optional<Point> origin;
+    std::vector<std::optional<std::string>> marks;
+    std::vector<std::optional<std::vector<int>>> rows;
+    std::vector<std::optional<Point>> stops;
+
+    bool operator==(const Item& t) const {
+        return name == t.name && active == t.active && id == t.id && count == t.count && price == t.price &&
+            ratio == t.ratio && tags == t.tags && grid == t.grid && discount == t.discount && note == t.note &&
+            at == t.at && path == t.path && origin == t.origin && marks == t.marks && rows == t.rows && stops == t.stops;
+    }
+};
+SOL_FIELDS(Item, name, active, id, count, price, ratio, tags, grid, discount, note, at, path, origin, marks, rows, stops)
+
+}
+
+namespace {
+
+std::string text(std::mt19937_64& rng) {
+    const char* pieces[] = {"a", "text", " ", "\"", "\\", "\t", "\n", "=", ",", "]", "}", "\xC3\xA9", "\xE4\xB8\xAD"};
+    std::string s;
+    for (int i = 0, n = rng() % 8; i < n; ++i)
+        s += pieces[rng() % (sizeof(pieces) / sizeof(*pieces))];
+    return s;
+}
+
+double real(std::mt19937_64& rng) {
+    uint64_t bits = rng();
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return std::isfinite(d) && rng() % 2 ? d : double(int64_t(rng()) % 1000) / 8;
+}
+
+test::Item item(std::mt19937_64& rng) {
+    test::Item t;
+    t.name = text(rng);
+    t.active = rng() % 2;
+    t.id = (long long)rng();
+    t.count = (unsigned)rng();
+    t.price = real(rng);
+    t.ratio = float(int(rng() % 1000)) / 3;
+    for (int i = 0, n = rng() % 4; i < n; ++i)
+        t.tags.push_back(text(rng));
+    for (int i = 0, n = rng() % 3; i < n; ++i)
+        t.grid.emplace_back(rng() % 3, int(rng()));
+    if (rng() % 2)
+        t.discount = real(rng);
+    if (rng() % 2)
+        t.note = text(rng);
+    t.at = {int(rng()), int(rng())};
+    for (int i = 0, n = rng() % 3; i < n; ++i)
+        t.path.push_back({int(rng() % 100), -int(rng() % 100)});
+    if (rng() % 2)
+        t.origin = test::Point{1, 2};
+    // Elements which are empty, and empty containers which are not.
+    for (int i = 0, n = rng() % 4; i < n; ++i) {
+        t.marks.push_back(rng() % 2 ? std::optional<std::string>(text(rng)) : std::nullopt);
+        t.rows.push_back(rng() % 2 ? std::optional<std::vector<int>>(std::vector<int>(rng() % 2, 5)) : std::nullopt);
+        t.stops.push_back(rng() % 2 ? std::optional<test::Point>(test::Point()) : std::nullopt);
+    }
+    return t;
+}
+
+void testRoundTrip() {
+    std::mt19937_64 rng(17);
+    for (int i = 0; i < 2000; ++i) {
+        std::vector<test::Item> items;
+        for (int j = 0, n = rng() % 4; j < n; ++j)
+            items.push_back(item(rng));
+        std::string out = sol::write(items);
+        std::vector<test::Item> back;
+        std::string error;
+        if (!CHECK(sol::read(out, back, &error) && back == items))
+            fprintf(stderr, "  \"%s\" reading %s\n", error.c_str(), out.c_str());
+
+        // A Reader reads the same members, empty optionals left out.
+        sol::Reader reader;
+        if (!CHECK(reader.fromString(out) && reader.result().array().size() == items.size()))
+            continue;
+        for (size_t j = 0; j < items.size(); ++j) {
+            sol::Value v = reader.result().array()[j];
+            const test::Item& t = items[j];
+            CHECK(v["name"].view() == t.name && v["active"].boolean() == t.active);
+            CHECK(v["id"].integer() == t.id && v["price"].real() == t.price);
+            CHECK(v["tags"].array().size() == t.tags.size() && v["path"].array().size() == t.path.size());
+            CHECK(v.object().count("discount") == t.discount.has_value());
+            CHECK(v.object().count("note") == t.note.has_value());
+            CHECK(v["at"]["x"].integer() == t.at.x && v["marks"].array().size() == t.marks.size());
+            // And the text Writer gives for it reads back as the same.
+            test::Item w;
+            CHECK(sol::read(sol::Writer().toString(v), w) && w == t);
+        }
+        // The indented text reads the same.
+        CHECK(sol::read(sol::Writer().toString(reader.result(), 4), back) && back == items);
+    }
+}
+
+void testRead() {
+    // Keys in any order, unknown ones skipped, a later duplicate winning.
+    test::Item t;
+    std::string s = "{ unknown = [{a=[]}, \"x\"], price = \"1.5\", name = \"first\", at = {y=\"2\", z={}, x=\"1\"},\n"
+        "  name = \"n\\tame\\u00E9\", id = \" +42 \", tags = [\"a\", \"b\",], }";
+    CHECK(sol::read(s, t) && t.name == "n\tame\xC3\xA9" && t.price == 1.5 && t.id == 42 && t.tags.size() == 2);
+    CHECK(t.at == (test::Point{1, 2}));
+    // Members without a key are left as they are.
+    t.count = 7;
+    CHECK(sol::read("{}", t) && t.count == 7 && t.name == "n\tame\xC3\xA9");
+    CHECK(sol::read<test::Point>("{x=\"3\"}") == (test::Point{3, 0}));
+    // Empty optionals keep their place in a vector.
+    std::vector<std::optional<int>> ints = {1, std::nullopt, 3};
+    CHECK(sol::write(ints) == "[\"1\",[],\"3\"]" && sol::read<std::vector<std::optional<int>>>("[\"1\",[],\"3\"]") == ints);
+    std::vector<std::optional<std::vector<int>>> rows = {std::vector<int>(), std::nullopt};
+    CHECK(sol::write(rows) == "[[],{}]" && sol::read<std::vector<std::optional<std::vector<int>>>>("[[],{}]") == rows);
+
+    struct Bad {
+        const char* text;
+        const char* error;
+    };
+    const Bad bad[] = {
+        {"{name=[]}", "Mismatched type@Line: 1 Column: 7"},
+        {"{tags=\"a\"}", "Mismatched type@Line: 1 Column: 7"},
+        {"{at=[]}", "Mismatched type@Line: 1 Column: 5"},
+        // Only an empty array stands for an empty optional.
+        {"{marks=[[\"a\"]]}", "Mismatched type@Line: 1 Column: 10"},
+        {"{marks=[{}]}", "Mismatched type@Line: 1 Column: 9"},
+        {"{rows=[{k=\"1\"}]}", "Mismatched type@Line: 1 Column: 9"},
+        {"{id=\"12x\"}", "Invalid number@Line: 1 Column: 5"},
+        {"{id=\"99999999999999999999\"}", "Invalid number@Line: 1 Column: 5"},
+        {"{count=\"-1\"}", "Invalid number@Line: 1 Column: 8"},
+        {"{active=\"yes\"}", "Invalid boolean@Line: 1 Column: 9"},
+        {"\"top\"", "Invalid string"},
+        {"", "Invalid string"},
+    };
+    for (const Bad& b: bad) {
+        std::string error;
+        test::Item t;
+        if (!CHECK(!sol::read(b.text, t, &error) && error == b.error))
+            fprintf(stderr, "  %s: \"%s\"\n", b.text, error.c_str());
+    }
+    // Syntax errors as a Reader reports them, in skipped keys too.
+    const char* syntax[] = {
+        "{name=\"a\"", "{name \"a\"}", "{name=\"a\" id=\"1\"}", "{unknown=[\"a\" \"b\"]}", "{unknown={k}}",
+        "{name=\"a\x01\"}", "{name=\"\\u12\"}", "{1name=\"a\"}", "{tags=[\"a\",,]}", "{path=[{x=\"1\"},]]}",
+    };
+    for (const char* text: syntax) {
+        std::string error;
+        test::Item t;
+        sol::Reader reader;
+        CHECK(!reader.fromString(text));
+        if (!CHECK(!sol::read(text, t, &error) && error == reader.error()))
+            fprintf(stderr, "  %s: \"%s\", reader \"%s\"\n", text, error.c_str(), reader.error().c_str());
+    }
+    // Value-initialized on errors.
+    CHECK(sol::read<test::Point>("{x=\"a\"}") == test::Point());
+}
+
+}
+
+int main() {
+    testRoundTrip();
+    testRead();
+    return sol::test::result();
+}
\ No newline at end of file
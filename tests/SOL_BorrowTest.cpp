@@ -0,0 +1,178 @@
+// Results parsed with Reader::borrow(): the same as those copied, with
+// their string values left in the input until a copy or string() asks for
+// a String, and copies, shared values and strings asked for which outlive
+// the input. Strings with escapes are decoded while parsing.
+
+#define SOL_TEST_ALLOCATIONS
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+const char* values[] = {
+    "\"\"", "\"short\"", "\"a value long enough to be out of the buffer of a String\"",
+    "\"tab\\tquote\\\"back\\\\ and long enough to be out of line\"", "\"\\u00E9\\u4E2D\"",
+    "\"\xC3\xA9\xE4\xB8\xAD raw UTF-8\"",
+};
+
+void element(std::mt19937& rng, std::string& s, int depth) {
+    int what = depth > 3 ? 0 : rng() % 4;
+    if (what < 2) {
+        s += values[rng() % (sizeof(values) / sizeof(*values))];
+        return;
+    }
+    bool object = what == 3;
+    s += object ? "{" : "[";
+    for (int i = 0, n = rng() % 5; i < n; ++i) {
+        if (i)
+            s += ",";
+        if (object)
+            s += "k" + std::to_string(i) + "=";
+        element(rng, s, depth + 1);
+    }
+    s += object ? "}" : "]";
+}
+
+std::string written(const sol::Value& v) {
+    return sol::Writer().toString(v);
+}
+
+bool inside(std::string_view v, const std::string& text) {
+    return v.data() >= text.data() && v.data() + v.length() <= text.data() + text.length();
+}
+
+// The strings of v in text, checked to be those without escapes if check
+// is set.
+size_t borrowed(const sol::Value& v, const std::string& text, bool check) {
+    if (v.isString()) {
+        std::string_view s = v.view();
+        bool escaped = s.find_first_of("\t\"\\") != s.npos || s == "\xC3\xA9\xE4\xB8\xAD";
+        if (check && !s.empty())
+            CHECK(inside(s, text) != escaped);
+        return !s.empty() && inside(s, text);
+    }
+    size_t n = 0;
+    if (v.isArray())
+        for (const sol::Value& e: v.array())
+            n += borrowed(e, text, check);
+    if (v.isObject())
+        for (auto& m: v.object())
+            n += borrowed(m.second, text, check);
+    return n;
+}
+
+void testRandom() {
+    std::mt19937 rng(6);
+    for (int i = 0; i < 2000; ++i) {
+        std::string text;
+        element(rng, text, 0);
+        sol::Reader copied;
+        if (!copied.fromString(text))
+            continue;
+        const std::string expected = written(copied.result());
+
+        std::string input = text;
+        sol::Reader reader;
+        reader.borrow(true);
+        if (!CHECK(reader.fromString(input) && written(reader.result()) == expected))
+            continue;
+        size_t n = borrowed(reader.result(), input, true);
+        sol::Value copy = reader.result();
+        sol::Value taken = reader.takeResult();
+        CHECK(borrowed(taken, input, false) == n);
+        CHECK(reader.fromString(input));
+        sol::Value shared = reader.shareResult();
+        CHECK(borrowed(copy, input, false) == 0 && borrowed(shared, input, false) == 0);
+        // Once the input is gone, only what was taken would point to it.
+        input.assign(input.size(), 'x');
+        input = std::string();
+        CHECK(written(copy) == expected && written(shared) == expected);
+    }
+}
+
+void testLazy() {
+    std::string input = "[\"a value long enough to be out of the buffer of a String\", \"\\u00E9scaped\", \"42\"]";
+    sol::Reader reader;
+    reader.borrow(true);
+    CHECK(reader.fromString(input));
+    sol::Value v = reader.takeResult();
+    sol::Array& a = v.array();
+    CHECK(inside(a[0].view(), input) && !inside(a[1].view(), input) && inside(a[2].view(), input));
+    CHECK(a[1].view() == "\xC3\xA9scaped" && a[2].integer() == 42);
+    // Only string() copies the text, and then once.
+    size_t before = sol::test::allocations();
+    std::string_view view = a[0].view();
+    CHECK(sol::test::allocations() == before && view.data() == input.data() + 2);
+    sol::String& s = a[0].string();
+    CHECK(sol::test::allocations() == before + 1 && !inside(s, input) && s == view);
+    CHECK(&a[0].string() == &s && sol::test::allocations() == before + 1);
+    // Which outlives the input, as a value assigned to does.
+    a[2] = sol::String("set");
+    input.assign(input.size(), 'x');
+    CHECK(a[0].view() == "a value long enough to be out of the buffer of a String" && a[2].view() == "set");
+
+    // Values borrowed directly.
+    const char text[] = "tab\\there and long enough to be out of line";
+    sol::Value raw = sol::Value::borrow(text, sizeof(text) - 1);
+    sol::Value decoded = sol::Value::borrow(text, sizeof(text) - 1, true);
+    CHECK(raw.view().data() == text && raw.view() == std::string_view(text));
+    CHECK(decoded.view() == "tab\there and long enough to be out of line");
+    sol::Value other = raw;
+    CHECK(other.view() == raw.view() && other.view().data() != text);
+}
+
+// Borrowed long strings make no allocation.
+void testAllocations() {
+    std::string input = "[";
+    for (int i = 0; i < 1000; ++i)
+        input += "\"a value long enough to be out of the buffer of a String\",";
+    input.back() = ']';
+    sol::Reader copied;
+    sol::Reader reader;
+    reader.borrow(true);
+    for (int i = 0; i < 2; ++i) {
+        size_t before = sol::test::allocations();
+        CHECK(copied.fromString(input));
+        size_t copying = sol::test::allocations() - before;
+        before = sol::test::allocations();
+        CHECK(reader.fromString(input));
+        size_t borrowing = sol::test::allocations() - before;
+        if (!CHECK(copying >= borrowing + 1000))
+            fprintf(stderr, "  %zu allocations copying, %zu borrowing\n", copying, borrowing);
+    }
+}
+
+// A mapped file is kept by the reader until its next parse.
+void testFile() {
+    std::string text = "{k=[\"a value long enough to be out of the buffer of a String\", \"\\tb\"]}";
+    const char* path = "SOL_BorrowTest.sol";
+    FILE* f = fopen(path, "wb");
+    if (!CHECK(f != nullptr))
+        return;
+    fwrite(text.data(), 1, text.size(), f);
+    fclose(f);
+    sol::Reader reader;
+    reader.borrow(true);
+    CHECK(reader.fromFile(path));
+    sol::Value copy = reader.result();
+    CHECK(reader.result().object().find("k")->second.array()[1].view() == "\tb");
+    CHECK(written(reader.result()) == "{k=[\"a value long enough to be out of the buffer of a String\",\"\\tb\"]}");
+    CHECK(reader.fromString("[]"));
+    remove(path);
+    CHECK(written(copy) == "{k=[\"a value long enough to be out of the buffer of a String\",\"\\tb\"]}");
+}
+
+}
+
+int main() {
+    testRandom();
+    testLazy();
+    testAllocations();
+    testFile();
+    return sol::test::result();
+}
\ No newline at end of file
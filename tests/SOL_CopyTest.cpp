@@ -0,0 +1,111 @@
+// Deep copies of arrays and objects (see Value::copies()) on the way from
+// the text to a result, and from a result to other values and to text:
+// only an explicit copy and a change of a shared value may make any.
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+// The deep copies made by f, which must be expected.
+template<typename F>
+void expect(const char* what, size_t expected, F f) {
+    size_t before = sol::Value::copies();
+    f();
+    size_t made = sol::Value::copies() - before;
+    if (!CHECK(expected == 0 ? made == 0 : made >= expected))
+        fprintf(stderr, "  %s: %zu deep copies\n", what, made);
+}
+
+}
+
+int main() {
+    std::string text = "[";
+    for (int i = 0; i < 20000; ++i)
+        text += "{id=\"" + std::to_string(i) + "\", tags=[\"a\",\"b\",{x=[]}], sub={k=\"v\"}},";
+    text += "]";
+
+    sol::Reader reader;
+    expect("parse", 0, [&]() {CHECK(reader.fromString(text));});
+    expect("parse on threads", 0, [&]() {
+        sol::Reader r;
+        r.threads(4);
+        CHECK(r.fromString(text));
+    });
+    expect("parse while recycling", 0, [&]() {
+        sol::Reader r;
+        r.recycle(true);
+        for (int i = 0; i < 3; ++i)
+            CHECK(r.fromString(text));
+    });
+    expect("parse into an arena", 0, [&]() {
+        sol::Arena arena;
+        sol::Reader r;
+        r.arena(&arena);
+        CHECK(r.fromString(text));
+        sol::Value v = r.takeResult();
+    });
+    expect("push parse", 0, [&]() {
+        sol::PushReader r;
+        for (size_t i = 0; i < text.size(); i += 777)
+            r.feed(text.data() + i, std::min<size_t>(777, text.size() - i));
+        CHECK(r.finish());
+    });
+
+    sol::Value v;
+    expect("take", 0, [&]() {v = reader.takeResult();});
+    expect("move", 0, [&]() {
+        sol::Value w(std::move(v));
+        v = std::move(w);
+    });
+    expect("vector growth", 0, [&]() {
+        std::vector<sol::Value> values;
+        // Not from an initializer list, whose elements can only be copied.
+        for (int i = 0; i < 100; ++i) {
+            sol::Array a;
+            a.emplace_back(sol::Object());
+            values.emplace_back(std::move(a));
+        }
+    });
+    expect("write", 0, [&]() {
+        sol::Writer w;
+        w.toString(v);
+        w.toString(v, 4);
+    });
+    expect("binary", 0, [&]() {
+        std::string b = sol::Binary::encode(v);
+        sol::Value w;
+        CHECK(sol::Binary::decode(b.data(), b.size(), w));
+    });
+
+    sol::Value shared;
+    expect("share", 0, [&]() {
+        CHECK(reader.fromString(text));
+        shared = reader.shareResult();
+        sol::Value again = reader.shareResult();
+    });
+    expect("copy of a shared value", 0, [&]() {
+        sol::Value a = shared;
+        sol::Value b;
+        b = shared;
+        const sol::Value& c = a;
+        sol::Value member = c.array()[0];
+    });
+    expect("Parser::result()", 0, [&]() {
+        CHECK(sol::Parser::fromString(text));
+        sol::Value a = sol::Parser::result();
+        sol::Value b = sol::Parser::result();
+    });
+
+    // The copies which have to be made, to know the counter works.
+    expect("copy", 1, [&]() {sol::Value w = v;});
+    expect("change of a shared value", 1, [&]() {
+        sol::Value w = shared;
+        w.array()[0]["id"] = sol::String("changed");
+    });
+    return sol::test::result();
+}
\ No newline at end of file
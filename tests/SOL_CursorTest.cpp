@@ -0,0 +1,125 @@
+// Cursors against the Values a Reader builds from the same text: the same
+// types, sizes, strings and members, except that a Cursor finds the first
+// of duplicate keys where a Reader keeps the last.
+
+#include <map>
+#include <random>
+#include <string>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+const char* values[] = {
+    "\"\"", "\"abc\"", "\"a ] } [ { , = b\"", "\"tab\\tquote\\\"back\\\\\"", "\"\\u00E9\\u4E2D\"",
+};
+// Few keys, so that objects often have the same one twice.
+const char* keys[] = {"k", "id", "_x", "k2"};
+
+void element(std::mt19937& rng, std::string& s, int depth) {
+    int what = depth > 4 ? 0 : rng() % 4;
+    if (what < 2) {
+        s += values[rng() % (sizeof(values) / sizeof(*values))];
+        return;
+    }
+    bool object = what == 3;
+    s += object ? "{" : "[";
+    for (int i = 0, n = rng() % 6; i < n; ++i) {
+        if (i)
+            s += rng() % 2 ? "," : " ,\n\t";
+        if (object) {
+            s += keys[rng() % (sizeof(keys) / sizeof(*keys))];
+            s += rng() % 2 ? "=" : " = ";
+        }
+        element(rng, s, depth + 1);
+    }
+    if (rng() % 8 == 0)
+        s += ",";
+    s += object ? "}" : "]";
+}
+
+std::string written(const sol::Value& v) {
+    return sol::Writer().toString(v);
+}
+
+// Compares c to v and everything in them.
+void compare(const sol::Cursor& c, const sol::Value& v) {
+    if (!CHECK(c.valid()))
+        return;
+    if (v.isString()) {
+        CHECK(c.isString() && c.getString() == v.view());
+        return;
+    }
+    // The text of a container parses back as the same value.
+    sol::Reader reader;
+    CHECK(reader.fromBuffer(c.text().data(), c.text().length()) && written(reader.result()) == written(v));
+    if (v.isArray()) {
+        const sol::Array& a = v.array();
+        if (!CHECK(c.isArray() && c.size() == a.size()))
+            return;
+        size_t i = 0;
+        for (sol::Cursor e = c.first(); e.valid(); e = e.next(), ++i) {
+            compare(e, a[i]);
+            CHECK(c[i].text() == e.text());
+        }
+        CHECK(i == a.size() && !c[a.size()].valid());
+        return;
+    }
+    if (!CHECK(c.isObject()))
+        return;
+    // The first and last member of each key.
+    std::map<std::string, sol::Cursor> first, last;
+    size_t n = 0;
+    for (sol::Cursor m = c.first(); m.valid(); m = m.next(), ++n) {
+        first.emplace(std::string(m.key()), m);
+        last[std::string(m.key())] = m;
+    }
+    CHECK(n == c.size());
+    const sol::Object& o = v.object();
+    CHECK(first.size() == o.size());
+    for (auto& i : first) {
+        sol::Cursor f = c[i.first];
+        CHECK(f.text().data() == i.second.text().data());
+        auto m = o.find(i.first);
+        if (CHECK(m != o.end()))
+            compare(last[i.first], m->second);
+    }
+    CHECK(!c["missing"].valid());
+}
+
+}
+
+int main() {
+    std::mt19937 rng(9);
+    for (int i = 0; i < 2000; ++i) {
+        std::string text;
+        element(rng, text, 0);
+        sol::Reader reader;
+        if (!reader.fromString(text))
+            continue;
+        compare(sol::Cursor(text), reader.result());
+    }
+
+    // The documented rule: the first of duplicate keys.
+    std::string dup = "{k=\"first\", other=[], k=\"second\"}";
+    sol::Reader reader;
+    CHECK(reader.fromString(dup));
+    CHECK(sol::Cursor(dup)["k"].getString() == "first");
+    CHECK(reader.result().object().find("k")->second.view() == "second");
+
+    // Malformed text gives invalid cursors where it is walked through, and
+    // valid ones before that.
+    std::string bad = "[\"a\", \"b\" x, \"c\"]";
+    sol::Cursor b(bad);
+    CHECK(b[0].getString() == "a" && b[1].getString() == "b" && !b[2].valid());
+    const std::string broken[] = {"{k \"v\"}", "{1k=\"v\"}", "{k=\"v\" k2=\"w\"}"};
+    for (const std::string& text: broken)
+        CHECK(sol::Cursor(text).isObject() && !sol::Cursor(text)["k2"].valid());
+    const std::string none[] = {"x", "", "  "};
+    for (const std::string& text: none)
+        CHECK(!sol::Cursor(text).valid());
+    std::string cut = "[\"unterminated";
+    CHECK(!sol::Cursor(cut)[0].getString(bad));
+    return sol::test::result();
+}
\ No newline at end of file
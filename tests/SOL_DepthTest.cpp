@@ -0,0 +1,131 @@
+// Nesting: maxDepth() passes documents exactly as deep as the limit and
+// fails those one deeper with "Too deep" and the position of the bracket,
+// the same way on one thread or several and pushed or not. Without a limit,
+// documents 100000 deep are parsed, written, copied, shared, encoded and
+// destroyed without overflowing the call stack.
+
+#include <string>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+struct Leaf {
+    std::string a;
+};
+SOL_FIELDS(Leaf, a)
+
+// n arrays, objects or both in turn, around one string.
+std::string nested(size_t n, int kind) {
+    std::string s;
+    for (size_t i = 0; i < n; ++i) {
+        bool object = kind == 1 || (kind == 2 && i % 2);
+        s += object ? "{a=" : (kind == 2 ? "[\"v\"," : "[");
+    }
+    s += "\"x\"";
+    for (size_t i = n; i-- > 0;) {
+        bool object = kind == 1 || (kind == 2 && i % 2);
+        s += object ? '}' : ']';
+    }
+    return s;
+}
+
+std::string written(const sol::Value& v) {
+    return sol::Writer().toString(v);
+}
+
+std::string pushed(const std::string& text, size_t limit, bool& ok) {
+    sol::PushReader push;
+    push.maxDepth(limit);
+    for (size_t i = 0; i < text.size(); i += 4096)
+        push.feed(text.data() + i, std::min<size_t>(4096, text.size() - i));
+    ok = push.finish();
+    return ok ? written(push.result()) : push.error();
+}
+
+void testLimit() {
+    for (int kind = 0; kind < 3; ++kind)
+        for (size_t n = 1; n < 40; n += 7) {
+            std::string text = nested(n, kind);
+            sol::Reader reader;
+            reader.maxDepth(n);
+            CHECK(reader.fromString(text) && written(reader.result()) == text);
+            bool ok = false;
+            CHECK(pushed(text, n, ok) == text && ok);
+            // The bracket one too deep, the n + 1-th opened.
+            reader.maxDepth(n - 1);
+            size_t at = 0;
+            for (size_t i = 0; i < n; ++i)
+                at = text.find_first_of("[{", i == 0 ? 0 : at + 1);
+            std::string error = "Too deep@Line: 1 Column: " + std::to_string(at + 1);
+            if (!CHECK(!reader.fromString(text) && reader.error() == error))
+                fprintf(stderr, "  %zu deep: \"%s\", expected \"%s\"\n", n, reader.error().c_str(), error.c_str());
+            CHECK(pushed(text, n - 1, ok) == error && !ok);
+        }
+    // 0 passes no array or object at all.
+    sol::Reader reader;
+    reader.maxDepth(0);
+    CHECK(!reader.fromString("[]") && reader.error() == "Too deep@Line: 1 Column: 1");
+    // Only the deepest part counts.
+    reader.maxDepth(3);
+    CHECK(reader.fromString("[[\"a\"], {k=[]}, [[]]]"));
+    CHECK(!reader.fromString("[[\"a\"], {k=[{}]}]") && reader.error() == "Too deep@Line: 1 Column: 13");
+
+    // A large array parsed on several threads fails at the same element.
+    std::string big = "[";
+    for (int i = 0; i < 40000; ++i)
+        big += i == 30000 ? "[[[[\"deep\"]]]]," : "[[\"a\"], \"b\"],";
+    big.back() = ']';
+    sol::Reader serial;
+    sol::Reader parallel;
+    parallel.threads(4);
+    for (size_t limit: {3, 4, 5}) {
+        serial.maxDepth(limit);
+        parallel.maxDepth(limit);
+        bool a = serial.fromString(big);
+        bool b = parallel.fromString(big);
+        CHECK(a == (limit == 5) && b == a && serial.error() == parallel.error());
+    }
+}
+
+void testDeep() {
+    const size_t n = 100000;
+    for (int kind = 0; kind < 3; ++kind) {
+        const std::string text = nested(n, kind);
+        sol::Reader reader;
+        if (!CHECK(reader.fromString(text)))
+            continue;
+        CHECK(written(reader.result()) == text);
+        // Pretty printed, though not indented: that would take n * n / 2
+        // spaces.
+        sol::Reader pretty;
+        CHECK(pretty.fromString(sol::Writer().toString(reader.result(), 0)) && written(pretty.result()) == text);
+        {
+            sol::Value copy = reader.result();
+            sol::Value shared = reader.shareResult();
+            sol::Value again = shared;
+            CHECK(written(copy) == text && written(again) == text);
+            std::string binary = sol::Binary::encode(again);
+            sol::Value decoded;
+            CHECK(sol::Binary::decode(binary, decoded) && written(decoded) == text);
+        }
+        bool ok = false;
+        CHECK(pushed(text, size_t(-1), ok) == text && ok);
+        reader.maxDepth(n);
+        CHECK(reader.fromString(text));
+        reader.maxDepth(n - 1);
+        CHECK(!reader.fromString(text) && reader.error().find("Too deep@") == 0);
+        // Skipped by sol::read.
+        Leaf leaf;
+        CHECK(sol::read("{b=" + text + ", a=\"q\"}", leaf) && leaf.a == "q");
+    }
+}
+
+}
+
+int main() {
+    testLimit();
+    testDeep();
+    return sol::test::result();
+}
\ No newline at end of file
@@ -0,0 +1,204 @@
+// Handlers: the events of random documents, in the order of their text,
+// from Reader (string, buffer and file), PushParser in chunks and a
+// Validator passing them on. A handler returning false stops the parse at
+// once, and onRawValue() gets the text of values before it is decoded.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+// Values, and what onValue() is given for them.
+const char* values[][2] = {
+    {"\"\"", ""}, {"\"abc\"", "abc"}, {"\"tab\\tquote\\\"\"", "tab\tquote\""},
+    {"\"\\u00E9\\u4E2D\"", "\xC3\xA9\xE4\xB8\xAD"}, {"\" ] } [ { , = \"", " ] } [ { , = "},
+};
+const char* keys[] = {"k", "k", "_id", "key2"};
+
+// Appends an element to text and its events to events, an array or an
+// object at the top.
+void element(std::mt19937& rng, std::string& text, std::vector<std::string>& events, int depth) {
+    int what = depth > 4 ? 0 : depth == 0 ? 2 + rng() % 2 : rng() % 4;
+    if (what < 2) {
+        auto& v = values[rng() % (sizeof(values) / sizeof(*values))];
+        text += v[0];
+        events.push_back(std::string("v:") + v[1]);
+        return;
+    }
+    bool object = what == 3;
+    text += object ? "{" : "[";
+    events.push_back(object ? "{" : "[");
+    int n = rng() % 5;
+    for (int i = 0; i < n; ++i) {
+        if (i)
+            text += rng() % 2 ? "," : " ,\n";
+        if (object) {
+            const char* k = keys[rng() % (sizeof(keys) / sizeof(*keys))];
+            text += k;
+            text += " = ";
+            events.push_back(std::string("k:") + k);
+        }
+        element(rng, text, events, depth + 1);
+    }
+    if (n != 0 && rng() % 8 == 0)
+        text += ",";
+    text += object ? "}" : "]";
+    events.push_back(object ? "}" : "]");
+}
+
+// Records the events, and returns false at the stop-th one.
+struct Recorder: sol::Handler {
+    std::vector<std::string> events;
+    size_t stop = size_t(-1);
+
+    bool onBeginArray() override {
+        return add("[");
+    }
+    bool onEndArray() override {
+        return add("]");
+    }
+    bool onBeginObject() override {
+        return add("{");
+    }
+    bool onKey(std::string_view k) override {
+        return add("k:" + std::string(k));
+    }
+    bool onEndObject() override {
+        return add("}");
+    }
+    bool onValue(std::string_view v) override {
+        return add("v:" + std::string(v));
+    }
+    bool add(std::string e) {
+        events.push_back(std::move(e));
+        return events.size() != stop;
+    }
+};
+
+// Not derived from Handler, it only has what it needs.
+struct Raw {
+    std::vector<std::string> events;
+
+    bool onBeginArray() {
+        events.push_back("[");
+        return true;
+    }
+    bool onEndArray() {
+        events.push_back("]");
+        return true;
+    }
+    bool onBeginObject() {
+        events.push_back("{");
+        return true;
+    }
+    bool onKey(std::string_view k) {
+        events.push_back("k:" + std::string(k));
+        return true;
+    }
+    bool onEndObject() {
+        events.push_back("}");
+        return true;
+    }
+    bool onValue(std::string_view) {
+        events.push_back("onValue");
+        return true;
+    }
+    bool onRawValue(std::string_view v, bool escaped) {
+        std::string s;
+        if (escaped)
+            sol::internal::Scanner::unescape(v.data(), v.data() + v.length(), s);
+        else
+            s = v;
+        CHECK(escaped == (v.find('\\') != v.npos));
+        events.push_back("v:" + s);
+        return true;
+    }
+};
+
+void pushed(const std::string& text, Recorder& r, size_t chunk) {
+    sol::PushParser<Recorder> push(r);
+    for (size_t i = 0; i < text.size(); i += chunk)
+        push.feed(text.data() + i, std::min(chunk, text.size() - i));
+    CHECK(push.finish());
+}
+
+void testOrder() {
+    std::mt19937 rng(7);
+    // Without rules, which every document passes.
+    sol::Schema schema;
+    for (int i = 0; i < 2000; ++i) {
+        std::string text;
+        std::vector<std::string> events;
+        element(rng, text, events, 0);
+        sol::Reader reader;
+        Recorder a;
+        if (!CHECK(reader.fromString(text, a) && a.events == events))
+            fprintf(stderr, "  %s\n", text.c_str());
+        Recorder b;
+        CHECK(reader.fromBuffer(text.data(), text.size(), b) && b.events == events);
+        Recorder c;
+        pushed(text, c, 1 + rng() % 7);
+        CHECK(c.events == events);
+        Raw raw;
+        CHECK(reader.fromString(text, raw) && raw.events == events);
+        // Through a Validator.
+        Recorder d;
+        reader.schema(&schema);
+        CHECK(reader.fromString(text, d) && d.events == events);
+        reader.schema(nullptr);
+        // Borrowing changes nothing for handlers.
+        Recorder e;
+        reader.borrow(true);
+        CHECK(reader.fromString(text, e) && e.events == events);
+    }
+
+    std::string text = "{a=[\"1\", {b=\"2\"}], c=\"3\"}";
+    const char* path = "SOL_HandlerTest.sol";
+    FILE* f = fopen(path, "wb");
+    if (CHECK(f != nullptr)) {
+        fwrite(text.data(), 1, text.size(), f);
+        fclose(f);
+        sol::Reader reader;
+        Recorder r;
+        CHECK(reader.fromFile(path, r));
+        CHECK((r.events == std::vector<std::string>{"{", "k:a", "[", "v:1", "{", "k:b", "v:2", "}", "]", "k:c", "v:3", "}"}));
+        remove(path);
+    }
+}
+
+// A handler returning false at any event: no event after it, and the parse
+// fails with the position of its token.
+void testAbort() {
+    const std::string text = "{a=[\"1\", {b=\"2\"}],\n c=\"3\"}";
+    const char* positions[] = {
+        "Line: 1 Column: 1", "Line: 1 Column: 2", "Line: 1 Column: 4", "Line: 1 Column: 5", "Line: 1 Column: 10",
+        "Line: 1 Column: 11", "Line: 1 Column: 13", "Line: 1 Column: 16", "Line: 1 Column: 17", "Line: 2 Column: 2",
+        "Line: 2 Column: 4", "Line: 2 Column: 7",
+    };
+    for (size_t stop = 1; stop <= 12; ++stop) {
+        sol::Reader reader;
+        Recorder r;
+        r.stop = stop;
+        std::string error = std::string("Aborted by handler@") + positions[stop - 1];
+        if (!CHECK(!reader.fromString(text, r) && r.events.size() == stop && reader.error() == error))
+            fprintf(stderr, "  at %zu: %zu events, \"%s\"\n", stop, r.events.size(), reader.error().c_str());
+        Recorder p;
+        p.stop = stop;
+        sol::PushParser<Recorder> push(p);
+        push.feed(text.data(), text.size());
+        CHECK(!push.finish() && p.events.size() == stop && push.error() == error);
+    }
+}
+
+}
+
+int main() {
+    testOrder();
+    testAbort();
+    return sol::test::result();
+}
\ No newline at end of file
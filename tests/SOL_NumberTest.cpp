@@ -0,0 +1,139 @@
+// Numbers in Values: the text formatted when one is set reads back as the
+// same number, and integer() and real() read text like std::stoll and
+// std::stod, with 0 where those would throw.
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+// The same bits, so that -0.0 and NaNs count too.
+bool same(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0 || (std::isnan(a) && std::isnan(b));
+}
+
+void testFormat() {
+    std::mt19937_64 rng(15);
+    const double specials[] = {
+        0.0, -0.0, 1.0, -1.0, 0.1, 0.25, 1.5, 1e300, -1e-300, 123456789.125,
+        std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+        std::numeric_limits<double>::min(), std::numeric_limits<double>::denorm_min(),
+        std::numeric_limits<double>::epsilon(), 9007199254740993.0,
+    };
+    for (double d: specials) {
+        sol::Value v(d);
+        CHECK(same(strtod(std::string(v.view()).c_str(), nullptr), d));
+        CHECK(same(sol::Value(std::string(v.view())).real(), d));
+    }
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t bits = rng();
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        if (!std::isfinite(d))
+            continue;
+        sol::Value v(d);
+        std::string text(v.view());
+        if (!CHECK(same(strtod(text.c_str(), nullptr), d) && same(v.real(), d)))
+            fprintf(stderr, "  %a written %s\n", d, text.c_str());
+        // Read back through the text, as after a round trip.
+        CHECK(same(sol::Value(text).real(), d));
+    }
+    // The shortest text: no digits beyond those needed.
+    CHECK(sol::Value(0.1).view() == "0.1");
+    CHECK(sol::Value(1.5).view() == "1.5");
+    CHECK(sol::Value(100.0).view() == "100");
+    const long long integers[] = {0, 1, -1, 42, std::numeric_limits<long long>::max(), std::numeric_limits<long long>::min()};
+    for (long long n: integers) {
+        sol::Value v(n);
+        CHECK(v.view() == std::to_string(n) && v.integer() == n);
+        CHECK(sol::Value(std::to_string(n)).integer() == n);
+        v = n;
+        CHECK(v.view() == std::to_string(n));
+    }
+    for (int i = 0; i < 100000; ++i) {
+        long long n = (long long)rng();
+        CHECK(sol::Value(n).view() == std::to_string(n));
+    }
+    CHECK(sol::Value(true).view() == "true" && sol::Value(false).view() == "false");
+    // The text written is the one formatted.
+    sol::Value a = sol::Array{sol::Value(0.25), sol::Value(7LL), sol::Value(true)};
+    CHECK(sol::Writer().toString(a) == "[\"0.25\",\"7\",\"true\"]");
+    // And string() turns it into a String.
+    sol::Value r(2.5);
+    CHECK(r.string() == "2.5" && r.real() == 2.5);
+}
+
+// Text, and what integer() and real() give for it.
+struct Read {
+    const char* text;
+    long long integer;
+    double real;
+};
+
+const Read reads[] = {
+    {"42", 42, 42.0},
+    {"  42", 42, 42.0},
+    {"\t\n-7", -7, -7.0},
+    {"+7", 7, 7.0},
+    {"42abc", 42, 42.0},
+    {"2.75", 2, 2.75},
+    {"-2.75e2", -2, -275.0},
+    {"1e3", 1, 1000.0},
+    {".5", 0, 0.5},
+    {"9223372036854775807", 9223372036854775807LL, 9223372036854775807.0},
+    // Where std::stoll and std::stod throw.
+    {"", 0, 0.0},
+    {"   ", 0, 0.0},
+    {"abc", 0, 0.0},
+    {"+-7", 0, 0.0},
+    {"-", 0, 0.0},
+    {"9223372036854775808", 0, 9223372036854775808.0},
+    {"-99999999999999999999", 0, -99999999999999999999.0},
+    {"1e400", 1, 0.0},
+    {"-1e400", -1, 0.0},
+    // Hexadecimal, which std::stod reads and std::stoll (in base 10) does
+    // not.
+    {"0x1A", 0, 26.0},
+    {"0X1a", 0, 26.0},
+    {"0x1p3", 0, 8.0},
+    {"-0x10", 0, -16.0},
+    {"  +0x1.8p1", 0, 3.0},
+    {"0x", 0, 0.0},
+    {"0xg", 0, 0.0},
+    {"0x1p99999", 0, 0.0},
+};
+
+void testRead() {
+    for (const Read& r: reads) {
+        sol::Value v{sol::String(r.text)};
+        if (!CHECK(v.integer() == r.integer && same(v.real(), r.real)))
+            fprintf(stderr, "  \"%s\": %lld %g\n", r.text, v.integer(), v.real());
+        // Borrowed text reads the same.
+        sol::Value b = sol::Value::borrow(r.text, strlen(r.text));
+        CHECK(b.integer() == r.integer && same(b.real(), r.real));
+    }
+    CHECK(std::isinf(sol::Value(sol::String("inf")).real()));
+    CHECK(std::isnan(sol::Value(sol::String("nan")).real()));
+    // Numbers stored as such, and other types.
+    CHECK(sol::Value(2.75).integer() == 2);
+    CHECK(sol::Value(7LL).real() == 7.0);
+    CHECK(sol::Value(true).integer() == 0 && sol::Value(true).boolean());
+    CHECK(!sol::Value(sol::String("True")).boolean() && sol::Value(sol::String("true")).boolean());
+    CHECK(sol::Value().integer() == 0 && sol::Value().real() == 0.0 && !sol::Value().boolean());
+    CHECK(sol::Value(sol::Array()).integer() == 0 && sol::Value(sol::Object()).real() == 0.0);
+}
+
+}
+
+int main() {
+    testFormat();
+    testRead();
+    return sol::test::result();
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+// Large top-level arrays parsed on several threads (see Reader::threads())
+// and on the calling thread only: both must give the same result, or fail
+// with the same error, on valid arrays as well as on arrays broken by a
+// bad closing bracket, a bad element or a stray comma.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+// Elements of the arrays, one of them at a time is replaced by one of the
+// broken ones.
+const char* elements[] = {
+    "\"abc\"",
+    "[\"abc\"]",
+    "{k=\"v\", l=[\"a\",\"b\"]}",
+    "[[], {}]",
+    "\"tab\\t\\u00E9 \\\" ] } , [ {\"",
+};
+const char* broken[] = {
+    "{}}", "[]}", "{]", "[}", "[", "{", "]", "}", "", "\"abc", "abc", "{k}",
+    "{k=}", "[\"a\",,\"b\"]", "\"a\" \"b\"", "\"\\u12\"", "\xFF", "\"a\x01\"",
+};
+// How the array ends.
+const char* closers[] = {"]", "}", ",]", ",}", ",,]", "", "] trailing", "]]"};
+
+std::string document(std::mt19937& rng, size_t bytes, bool broke, const char* closer) {
+    std::string s = "[";
+    size_t bad = broke ? rng() % 40000 : size_t(-1);
+    for (size_t i = 0; s.size() < bytes; ++i) {
+        if (i != 0)
+            s += ",";
+        if (rng() % 3 == 0)
+            s += " \n";
+        s += i == bad ? broken[rng() % (sizeof(broken) / sizeof(*broken))] : elements[rng() % (sizeof(elements) / sizeof(*elements))];
+    }
+    return s + closer;
+}
+
+void compare(const std::string& text, const char* what) {
+    sol::Reader serial;
+    sol::Reader parallel;
+    parallel.threads(4);
+    bool a = serial.fromString(text);
+    bool b = parallel.fromString(text);
+    bool same = a == b && serial.error() == parallel.error();
+    if (same && a)
+        same = sol::Writer().toString(serial.result()) == sol::Writer().toString(parallel.result());
+    if (!CHECK(same))
+        fprintf(stderr, "  %s: serial %d \"%s\", parallel %d \"%s\"\n", what, a, serial.error().c_str(), b, parallel.error().c_str());
+}
+
+}
+
+int main() {
+    std::mt19937 rng(11);
+    // Past the size from which threads are used.
+    const size_t bytes = 512 * 1024;
+    for (const char* closer: closers) {
+        compare(document(rng, bytes, false, closer), closer);
+        for (int i = 0; i < 4; ++i)
+            compare(document(rng, bytes, true, closer), closer);
+    }
+    for (const char* b: broken) {
+        // Right at the start and at the end, next to the first and last cut.
+        compare("[" + std::string(b) + "," + document(rng, bytes, false, "]").substr(1), b);
+        std::string d = document(rng, bytes, false, "");
+        compare(d + "," + b + "]", b);
+    }
+    // An element whose '}' closes the array for an index which only counts
+    // brackets.
+    std::string d = "[";
+    for (int i = 0; i < 40000; ++i)
+        d += i == 5000 ? "{}}," : "[\"abc\"],";
+    d.back() = ']';
+    compare(d, "{}}");
+    sol::Reader reader;
+    reader.threads(4);
+    CHECK(!reader.fromString(d) && reader.error().find("Invalid array@") == 0);
+    return sol::test::result();
+}
\ No newline at end of file
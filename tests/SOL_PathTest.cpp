@@ -0,0 +1,183 @@
+// Path and PathSet against the sol::check they replaced, kept here as it
+// was: the same result for random values and paths, with every kind of
+// step, missing keys and indexes, empty steps and bad types, whether the
+// paths are checked one at a time or as one list.
+
+#include <cctype>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace old {
+
+// Inserts a Null for a missing key, only called on copies.
+bool check(const sol::Value& v, const std::string& path, sol::ValueType type) {
+    size_t p = path.find_first_of('.');
+    std::string lb;
+    if (p == path.npos)
+        lb = path;
+    else
+        lb = path.substr(0, p);
+    if (lb.length() == 0)
+        return false;
+    bool f = false;
+    for (auto& i : lb)
+        if (!isdigit((unsigned char)i)) {
+            f = true;
+            break;
+        }
+    if (f) {
+        if (!v.isObject())
+            return false;
+        if (p == path.npos)
+            return const_cast<sol::Value&>(v).object()[lb].type() == type;
+        else
+            return old::check(const_cast<sol::Value&>(v).object()[lb], path.substr(p + 1), type);
+    }
+    else {
+        if (!v.isArray())
+            return false;
+        size_t a = std::stoull(lb);
+        if (const_cast<sol::Value&>(v).array().size() <= a)
+            return false;
+        if (p == path.npos)
+            return const_cast<sol::Value&>(v).array()[a].type() == type;
+        else
+            return old::check(const_cast<sol::Value&>(v).array()[a], path.substr(p + 1), type);
+    }
+}
+
+std::vector<int> check(const sol::Value& v, const std::vector<std::string>& ls) {
+    std::vector<int> rtn;
+    int cnt = 0;
+    for (auto& i : ls) {
+        size_t p = i.find_first_of(':');
+        if (p == i.npos) {
+            rtn.emplace_back(-1);
+            ++cnt;
+            continue;
+        }
+        std::string lb = i.substr(p + 1);
+        sol::ValueType t;
+        if (lb == "Array")
+            t = sol::VALUE_ARRAY;
+        else if (lb == "Object")
+            t = sol::VALUE_OBJECT;
+        else if (lb == "String")
+            t = sol::VALUE_STRING;
+        else if (lb == "Null")
+            t = sol::VALUE_NULL;
+        else {
+            rtn.emplace_back(-2);
+            ++cnt;
+            continue;
+        }
+        if (old::check(v, i.substr(0, p), t))
+            rtn.emplace_back(1);
+        else {
+            rtn.emplace_back(0);
+            ++cnt;
+        }
+    }
+    rtn.emplace_back(cnt);
+    return rtn;
+}
+
+}
+
+namespace {
+
+// Keys made of digits are not found by a path, whose digit steps are
+// indexes.
+const char* steps[] = {"a", "b", "x1", "0", "1", "2", "00", ""};
+const char* types[] = {":Array", ":Object", ":String", ":Null", ":Bogus", ""};
+
+sol::Value value(std::mt19937& rng, int depth) {
+    int what = depth > 3 ? rng() % 2 : rng() % 4;
+    if (what == 0)
+        return sol::Value();
+    if (what == 1)
+        return sol::String(rng() % 2 ? "text" : "");
+    sol::Value v = what == 2 ? sol::Value(sol::Array()) : sol::Value(sol::Object());
+    for (int i = 0, n = rng() % 4; i < n; ++i) {
+        if (what == 2)
+            v.array().push_back(value(rng, depth + 1));
+        else
+            v[steps[rng() % 4]] = value(rng, depth + 1);
+    }
+    if (what == 3 && rng() % 4 == 0)
+        v["0"] = sol::String("a key of digits");
+    return v;
+}
+
+std::string path(std::mt19937& rng) {
+    std::string s;
+    for (int i = 0, n = 1 + rng() % 4; i < n; ++i) {
+        if (i)
+            s += ".";
+        s += steps[rng() % (sizeof(steps) / sizeof(*steps))];
+    }
+    return s;
+}
+
+sol::ValueType type(const std::string& entry) {
+    std::string t = entry.substr(entry.find(':') + 1);
+    return t == "Array" ? sol::VALUE_ARRAY : t == "Object" ? sol::VALUE_OBJECT : t == "String" ? sol::VALUE_STRING : sol::VALUE_NULL;
+}
+
+}
+
+int main() {
+    std::mt19937 rng(13);
+    const sol::ValueType all[] = {sol::VALUE_ARRAY, sol::VALUE_OBJECT, sol::VALUE_STRING, sol::VALUE_NULL};
+    for (int i = 0; i < 3000; ++i) {
+        const sol::Value v = value(rng, 0);
+        const std::string written = sol::Writer().toString(v);
+        std::vector<std::string> ls;
+        for (int j = 0, n = rng() % 24; j < n; ++j)
+            ls.push_back(path(rng) + types[rng() % (sizeof(types) / sizeof(*types))]);
+        // A path more than once.
+        if (!ls.empty())
+            ls.push_back(ls[rng() % ls.size()]);
+
+        // The old list inserted Nulls as it went on, so into one copy.
+        sol::Value copy = v;
+        std::vector<int> expected = old::check(copy, ls);
+        if (!CHECK(sol::check(v, ls) == expected))
+            fprintf(stderr, "  list of %zu paths in %s\n", ls.size(), written.c_str());
+        sol::PathSet set;
+        for (const std::string& entry: ls)
+            set.add(entry);
+        CHECK(set.size() == ls.size() && set.check(v) == expected);
+
+        for (const std::string& entry: ls) {
+            std::string p = entry.substr(0, entry.find(':'));
+            for (sol::ValueType t: all) {
+                sol::Value copy = v;
+                if (!CHECK(sol::Path(p).check(v, t) == old::check(copy, p, t)))
+                    fprintf(stderr, "  %s:%d in %s\n", p.c_str(), int(t), written.c_str());
+            }
+            // What get() finds is what check() passes.
+            const sol::Value* found = sol::Path(p).get(v);
+            if (found != nullptr)
+                CHECK(sol::Path(p).check(v, found->type()));
+            if (entry.find(':') != entry.npos)
+                CHECK(sol::Path(p).check(v, type(entry)) == sol::check(v, p, type(entry)));
+        }
+        // Nothing was inserted.
+        CHECK(sol::Writer().toString(v) == written);
+    }
+
+    // What set() stores, get() finds.
+    sol::Value v;
+    CHECK(sol::Path("a.2.b").set(v, sol::String("x")));
+    CHECK(sol::Path("a.2.b").get(v)->view() == "x" && v["a"].array().size() == 3);
+    CHECK(sol::Path("a.0").check(v, sol::VALUE_NULL) && !sol::Path("a.3").check(v, sol::VALUE_NULL));
+    CHECK(!sol::Path("a..b").valid() && !sol::Path("a..b").set(v, sol::Value()));
+    CHECK(!sol::Path("a.99999999999999999999999").check(v, sol::VALUE_NULL));
+    CHECK(!sol::Path("a.99999999999999999999999").set(v, sol::Value()));
+    return sol::test::result();
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+// PushReader against Reader: the same documents, valid or not, pushed a
+// byte at a time, in chunks of 1 to 7 bytes and cut at every position of
+// strings, escapes and \uXXXX escapes, must give the same result or the
+// same error.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+// Pieces of documents, put together at random.
+const char* values[] = {
+    "\"\"", "\"abc\"", "\"tab\\tquote\\\"back\\\\\"", "\"\\u00E9\\u4E2D\\u0041\"",
+    "\"\\u12\"", "\"\\uZZZZ\"", "\"\\q\"", "\"\xC3\xA9\xE4\xB8\xAD\"",
+};
+const char* keys[] = {"k", "_a1", "key_2", "Z"};
+// Bytes which break a document when they replace one of it.
+const char* breakers[] = {"", "\"", "\\", "{", "}", "[", "]", "=", ",", "1", " ", "\x01", "\xFF", "#"};
+
+void element(std::mt19937& rng, std::string& s, int depth) {
+    int what = depth > 3 ? 0 : rng() % 4;
+    if (what < 2) {
+        s += values[rng() % (sizeof(values) / sizeof(*values))];
+        return;
+    }
+    bool object = what == 3;
+    s += object ? "{" : "[";
+    for (int i = 0, n = rng() % 5; i < n; ++i) {
+        if (i)
+            s += rng() % 2 ? "," : " ,\n ";
+        if (object) {
+            s += keys[rng() % (sizeof(keys) / sizeof(*keys))];
+            s += rng() % 2 ? "=" : " = ";
+        }
+        element(rng, s, depth + 1);
+    }
+    if (rng() % 8 == 0)
+        s += ",";
+    s += object ? "}" : "]";
+}
+
+std::string document(std::mt19937& rng) {
+    std::string s;
+    if (rng() % 4 == 0)
+        s += " \n\t";
+    element(rng, s, rng() % 2);
+    if (rng() % 3 == 0) {
+        size_t at = rng() % (s.size() + 1);
+        const char* b = breakers[rng() % (sizeof(breakers) / sizeof(*breakers))];
+        if (at < s.size() && rng() % 2)
+            s.replace(at, 1, b);
+        else
+            s.insert(at, b);
+    }
+    if (rng() % 5 == 0)
+        s.resize(rng() % (s.size() + 1));
+    return s;
+}
+
+// Pushes text cut at the given lengths, the rest of it in one chunk.
+void compare(const std::string& text, const std::vector<size_t>& cuts, const char* how) {
+    sol::Reader reader;
+    bool a = reader.fromString(text);
+    sol::PushReader push;
+    size_t at = 0;
+    for (size_t n: cuts) {
+        if (at >= text.size())
+            break;
+        n = std::min(n, text.size() - at);
+        push.feed(text.data() + at, n);
+        at += n;
+    }
+    if (at < text.size())
+        push.feed(text.data() + at, text.size() - at);
+    bool b = push.finish();
+    bool same = a == b && reader.error() == push.error();
+    if (same && a)
+        same = sol::Writer().toString(reader.result()) == sol::Writer().toString(push.result());
+    if (!CHECK(same))
+        fprintf(stderr, "  %s of %s: reader %d \"%s\", push %d \"%s\"\n", how, text.c_str(), a, reader.error().c_str(), b, push.error().c_str());
+}
+
+}
+
+int main() {
+    std::mt19937 rng(10);
+    for (int i = 0; i < 3000; ++i) {
+        std::string text = document(rng);
+        compare(text, std::vector<size_t>(text.size(), 1), "bytes");
+        std::vector<size_t> cuts;
+        for (size_t n = 0; n < text.size(); n += cuts.back())
+            cuts.push_back(1 + rng() % 7);
+        compare(text, cuts, "chunks");
+    }
+    // In two chunks cut at every position, so inside every string, escape
+    // and \uXXXX.
+    const std::string texts[] = {
+        "[\"plain text\", \"a\\tb\\nc\\rd\\\"e\\\\f\", \"\\u00E9\\u4E2D\\u0041x\"]",
+        "{key=\"\\u12\", other_key=[\"\\uZZZZ\", \"\\u\"], k=\"\\q\"}",
+        "[\"unterminated \\u00E",
+        "[\"bad \x01 character\"]",
+        "  \"a top-level string\"",
+        "",
+    };
+    for (const std::string& text: texts)
+        for (size_t at = 0; at <= text.size(); ++at)
+            compare(text, {at}, "two chunks");
+    return sol::test::result();
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+// A reader which recycles its results (see Reader::recycle()): what it
+// gives after a result was shared, taken or kept in an arena, after a
+// parse failed, and that it parses a stream of messages without any
+// allocation once it has warmed up.
+
+#define SOL_TEST_ALLOCATIONS
+
+#include <string>
+#include <vector>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+// An object, the outermost container in an arena.
+const std::string text = "{list=[{id=\"1\", tags=[\"a\",\"b\"], name=\"a name long enough to be on the heap\"}, {id=\"2\"}]}";
+const std::string other = "{k=[\"v\"]}";
+const std::string broken = "[{id=\"1\", tags=[\"a\"";
+
+// The text of v, to compare results.
+std::string written(const sol::Value& v) {
+    return sol::Writer().toString(v);
+}
+
+// The text of the result of t parsed by a reader of its own.
+std::string parsed(const std::string& t) {
+    sol::Reader reader;
+    CHECK(reader.fromString(t));
+    return written(reader.result());
+}
+
+}
+
+int main() {
+    const std::string expected = parsed(text);
+
+    // A failed parse leaves no result, whatever the last one became.
+    for (int last = 0; last < 4; ++last) {
+        sol::Arena arena;
+        sol::Reader reader;
+        reader.recycle(true);
+        if (last == 3)
+            reader.arena(&arena);
+        CHECK(reader.fromString(text));
+        sol::Value kept;
+        if (last == 1)
+            kept = reader.shareResult();
+        else if (last == 2)
+            kept = reader.takeResult();
+        if (!CHECK(!reader.fromString(broken)) || !CHECK(reader.result().isNull()))
+            fprintf(stderr, "  after result %d\n", last);
+        // The result kept is not taken apart by the parses which follow.
+        CHECK(reader.fromString(other));
+        CHECK(written(reader.result()) == parsed(other));
+        if (last == 1 || last == 2)
+            CHECK(written(kept) == expected);
+        CHECK(reader.fromString(text));
+        CHECK(written(reader.result()) == expected);
+    }
+
+    // Messages of a few shapes, with long and escaped strings, nested
+    // containers and objects large enough to be indexed.
+    std::vector<std::string> messages;
+    for (int i = 0; i < 200; ++i) {
+        std::string m = "{id=\"" + std::to_string(i) + "\", kind=\"" + std::string(i % 40, 'k') + "\"";
+        if (i % 2)
+            m += ", text=\"tab\\tquote\\\"\\u00E9 long enough to be on the heap\"";
+        if (i % 3)
+            m += ", tags=[\"a\", [\"b\", {}], {c=[]}]";
+        if (i % 5 == 0)
+            m += ", a1=\"1\", a2=\"2\", a3=\"3\", a4=\"4\", a5=\"5\", a6=\"6\", a7=\"7\", a8=\"8\"";
+        messages.push_back("[" + m + "}]");
+    }
+    sol::Reader reader;
+    reader.recycle(true);
+    for (const std::string& m: messages)
+        CHECK(reader.fromString(m));
+    size_t before = sol::test::allocations();
+    for (int round = 0; round < 3; ++round)
+        for (const std::string& m: messages)
+            CHECK(reader.fromString(m));
+    size_t made = sol::test::allocations() - before;
+    if (!CHECK(made == 0))
+        fprintf(stderr, "  %zu allocations for %zu messages\n", made, 3 * messages.size());
+    return sol::test::result();
+}
\ No newline at end of file
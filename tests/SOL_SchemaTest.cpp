@@ -0,0 +1,226 @@
+// Schemas checked on values with Schema::validate() and while parsing with
+// Reader::schema(): both must give what each rule gives on its own (as
+// written in the comment of Schema), and a parse must stop with the rule
+// violated and the position of the value violating it.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+const char* keys[] = {"a", "b", "x1"};
+const char* types[] = {"Null", "Array", "Object", "String"};
+
+sol::Value value(std::mt19937& rng, int depth) {
+    // No Nulls, which are not written: the text must read back as v.
+    int what = depth > 3 ? 0 : rng() % 4;
+    if (what < 2)
+        return sol::String(what ? "text" : "");
+    sol::Value v = what == 2 ? sol::Value(sol::Array()) : sol::Value(sol::Object());
+    for (int i = 0, n = rng() % 4; i < n; ++i) {
+        if (what == 2)
+            v.array().push_back(value(rng, depth + 1));
+        else
+            v[keys[rng() % 3]] = value(rng, depth + 1);
+    }
+    return v;
+}
+
+// A rule on a path through v most of the time, with steps it lacks or
+// which do not fit it otherwise, and often the type found there.
+std::string rule(std::mt19937& rng, const sol::Value* v) {
+    std::string s;
+    for (int i = 0, n = 1 + rng() % 4; i < n; ++i) {
+        if (i && (v == nullptr || v->isString()) && rng() % 4 != 0)
+            break;
+        if (i)
+            s += ".";
+        if (v != nullptr && v->isArray() && !v->array().empty() && rng() % 8 != 0) {
+            size_t e = rng() % v->array().size();
+            s += rng() % 3 == 0 ? "*" : std::to_string(e);
+            v = &v->array()[e];
+        }
+        else if (v != nullptr && v->isObject() && !v->object().empty() && rng() % 8 != 0) {
+            auto it = v->object().begin();
+            std::advance(it, rng() % v->object().size());
+            s += it->first;
+            v = &it->second;
+        }
+        else {
+            const char* other[] = {"a", "nokey", "0", "5", "*"};
+            s += other[rng() % 5];
+            v = nullptr;
+        }
+    }
+    bool found = v != nullptr && s.find('*') == s.npos && rng() % 4 != 0;
+    s += std::string(":") + types[found ? size_t(v->type()) : rng() % 4];
+    return rng() % 4 == 0 ? s + "?" : s;
+}
+
+// One rule on its own: an optional one passes where its path does not
+// exist, "*" stands for every element.
+bool passes(const sol::Value* v, const std::vector<std::string>& steps, size_t i, sol::ValueType type, bool optional) {
+    if (i == steps.size())
+        return v->type() == type;
+    const std::string& s = steps[i];
+    bool last = i + 1 == steps.size();
+    if (s == "*") {
+        if (!v->isArray())
+            return false;
+        for (const sol::Value& e: v->array())
+            if (!passes(&e, steps, i + 1, type, optional))
+                return false;
+        return true;
+    }
+    if (s.find_first_not_of("0123456789") == s.npos) {
+        if (!v->isArray())
+            return false;
+        size_t pos = std::stoull(s);
+        if (pos >= v->array().size())
+            return optional;
+        return passes(&v->array()[pos], steps, i + 1, type, optional);
+    }
+    if (!v->isObject())
+        return false;
+    auto it = v->object().find(s);
+    if (it == v->object().end())
+        return optional || (last && type == sol::VALUE_NULL);
+    return passes(&it->second, steps, i + 1, type, optional);
+}
+
+bool passes(const sol::Value& v, const std::string& rule) {
+    size_t p = rule.find(':');
+    std::string t = rule.substr(p + 1);
+    bool optional = t.back() == '?';
+    if (optional)
+        t.pop_back();
+    std::vector<std::string> steps;
+    for (size_t b = 0, e; b <= p; b = e + 1) {
+        e = rule.find('.', b);
+        if (e == rule.npos || e > p)
+            e = p;
+        steps.push_back(rule.substr(b, e - b));
+    }
+    sol::ValueType type = t == "Array" ? sol::VALUE_ARRAY : t == "Object" ? sol::VALUE_OBJECT : t == "String" ? sol::VALUE_STRING : sol::VALUE_NULL;
+    return passes(&v, steps, 0, type, optional);
+}
+
+void testRandom() {
+    std::mt19937 rng(14);
+    for (int i = 0; i < 3000; ++i) {
+        sol::Value v = value(rng, 0);
+        std::string text = sol::Writer().toString(v);
+        for (int j = 0; j < 8; ++j) {
+            std::vector<std::string> rules;
+            bool expected = true;
+            for (int k = 0, n = 1 + rng() % 3; k < n; ++k) {
+                rules.push_back(rule(rng, &v));
+                expected = passes(v, rules.back()) && expected;
+            }
+            sol::Schema schema(rules);
+            if (!CHECK(schema.valid()))
+                continue;
+            std::string msg;
+            bool a = schema.validate(v, msg);
+            sol::Reader reader;
+            reader.schema(&schema);
+            bool b = v.isString() ? a : reader.fromString(text);
+            if (!CHECK(a == expected && b == expected)) {
+                fprintf(stderr, "  expected %d, validate %d, parse %d \"%s\" for", expected, a, b, reader.error().c_str());
+                for (const std::string& r: rules)
+                    fprintf(stderr, " %s", r.c_str());
+                fprintf(stderr, " in %s\n", text.c_str());
+            }
+            // The rule violated is one of those given.
+            if (!a) {
+                CHECK(msg.find("Schema violation ") == 0);
+                bool found = false;
+                for (const std::string& r: rules)
+                    found = found || msg == "Schema violation " + r;
+                CHECK(found);
+            }
+            if (!b && !v.isString())
+                CHECK(reader.error().find("Schema violation ") == 0 && reader.error().find("@Line: ") != std::string::npos);
+            // Without a violation, the result is the one built without a
+            // schema.
+            sol::Reader plain;
+            if (b && !v.isString())
+                CHECK(plain.fromString(text) && sol::Writer().toString(reader.result()) == sol::Writer().toString(plain.result()));
+        }
+    }
+}
+
+// Violations and where a parse stops for them.
+struct Case {
+    const char* text;
+    const char* rule;
+    const char* error;
+};
+
+const Case cases[] = {
+    {"{\n  a = [\"x\",\n    {}]\n}", "a.1:String", "Schema violation a.1:String@Line: 3 Column: 5"},
+    // A missing key at the end of its object.
+    {"{\n  a = [\"x\"],\n  b = \"y\"\n}", "c:String", "Schema violation c:String@Line: 4 Column: 1"},
+    {"{\n  a = [\"x\"]\n}", "c:Null", ""},
+    {"{\n  a = [\"x\"]\n}", "c.d:Null", "Schema violation c.d:Null@Line: 3 Column: 1"},
+    // A missing index at the end of its array.
+    {"{\n  a = [\"x\"]\n}", "a.3:String", "Schema violation a.3:String@Line: 2 Column: 11"},
+    {"{\n  a = [\"x\"]\n}", "a.3:String?", ""},
+    {"{a=[\"x\"]}", "a.3.b:String?", ""},
+    {"{a=\"x\"}", "a.b:String?", "Schema violation a.b:String?@Line: 1 Column: 4"},
+    {"[{n=\"1\"}, {n=\"2\"}, {m=\"3\"}]", "*.n:String", "Schema violation *.n:String@Line: 1 Column: 26"},
+    {"[{n=\"1\"}, {n=\"2\"}, {m=\"3\"}]", "*.n:String?", ""},
+    {"[{n=\"1\"}, {n=[]}]", "*.n:String?", "Schema violation *.n:String?@Line: 1 Column: 14"},
+};
+
+void testCases() {
+    for (const Case& c: cases) {
+        sol::Schema schema({c.rule});
+        sol::Reader reader;
+        reader.schema(&schema);
+        bool ok = reader.fromString(c.text);
+        if (!CHECK(ok == (*c.error == 0) && reader.error() == c.error))
+            fprintf(stderr, "  %s: \"%s\"\n", c.rule, reader.error().c_str());
+        // And on the value built without the schema.
+        sol::Reader plain;
+        CHECK(plain.fromString(c.text) && schema.validate(plain.result()) == ok);
+    }
+    // Every occurrence of a repeated key is validated while parsing, though
+    // the result keeps the last.
+    sol::Schema schema({"a:String"});
+    sol::Reader reader;
+    CHECK(reader.fromString("{a=[], a=\"x\"}") && schema.validate(reader.result()));
+    reader.schema(&schema);
+    CHECK(!reader.fromString("{a=[], a=\"x\"}") && reader.error() == "Schema violation a:String@Line: 1 Column: 4");
+    // After a violation, the next parse starts afresh.
+    CHECK(!reader.fromString("{a=[]}") && reader.fromString("{a=\"x\"}"));
+    reader.schema(nullptr);
+    CHECK(reader.fromString("{a=[]}"));
+}
+
+void testInvalid() {
+    const char* invalid[] = {"a", "a:Foo", "a:", "a..b:String", ":String", "a.:String", "a:String??"};
+    for (const char* rule: invalid) {
+        sol::Schema schema;
+        CHECK(!schema.add(rule) && !schema.valid());
+        CHECK(schema.error() == std::string("Invalid schema rule ") + rule);
+    }
+    // The first error is kept, the valid rules are still added.
+    sol::Schema schema({"a:String", "b", "c:Foo"});
+    CHECK(!schema.valid() && schema.error() == "Invalid schema rule b");
+    sol::Reader reader;
+    CHECK(reader.fromString("{a=[]}") && !schema.validate(reader.result()));
+}
+
+}
+
+int main() {
+    testRandom();
+    testCases();
+    testInvalid();
+    return sol::test::result();
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+// The scalar, SSE2 and AVX2 scans of SOL_Simd.hpp against each other on
+// every byte, and the escapes written and read on both sides of the 16
+// and 32 byte blocks the vector scans work on.
+
+#include <string>
+#include <vector>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+using Kernel = const char* (*)(const char*, const char*);
+
+// A scan, what it stops at and its kernels, nullptr for the ones this
+// build or CPU does not have.
+struct Scan {
+    const char* name;
+    bool (*stop)(unsigned char);
+    Kernel scalar;
+    Kernel sse2;
+    Kernel avx2;
+};
+
+std::vector<Scan> scans() {
+    using namespace sol::internal;
+    std::vector<Scan> rtn = {
+        {"value", isValueStop, findValueStopScalar, nullptr, nullptr},
+        {"escape", [](unsigned char c) {return isEscapeStop(c, false);}, [](const char* p, const char* e) {return findEscapeStopScalar(p, e, false);}, nullptr, nullptr},
+        {"escape high", [](unsigned char c) {return isEscapeStop(c, true);}, [](const char* p, const char* e) {return findEscapeStopScalar(p, e, true);}, nullptr, nullptr},
+        {"bracket", isBracketStop, findBracketStopScalar, nullptr, nullptr},
+        {"struct", isStructStop, findStructStopScalar, nullptr, nullptr},
+    };
+#if defined(SOL_SIMD_X86)
+    rtn[0].sse2 = findValueStopSse2;
+    rtn[1].sse2 = [](const char* p, const char* e) {return findEscapeStopSse2(p, e, false);};
+    rtn[2].sse2 = [](const char* p, const char* e) {return findEscapeStopSse2(p, e, true);};
+    rtn[3].sse2 = findBracketStopSse2;
+    rtn[4].sse2 = findStructStopSse2;
+    if (__builtin_cpu_supports("avx2")) {
+        rtn[0].avx2 = findValueStopAvx2;
+        rtn[1].avx2 = [](const char* p, const char* e) {return findEscapeStopAvx2(p, e, false);};
+        rtn[2].avx2 = [](const char* p, const char* e) {return findEscapeStopAvx2(p, e, true);};
+        rtn[3].avx2 = findBracketStopAvx2;
+        rtn[4].avx2 = findStructStopAvx2;
+    }
+#endif
+    return rtn;
+}
+
+// Lengths around the block sizes, and the positions of a stop in them.
+const size_t lengths[] = {0, 1, 2, 15, 16, 17, 31, 32, 33, 47, 48, 49, 63, 64, 65, 95, 96, 97};
+const size_t offsets[] = {0, 1, 7};
+
+// Every byte at every position of every length, from a start which is and
+// is not aligned: each kernel must stop where the definition of its scan
+// does.
+void testScans() {
+    std::vector<char> buf(128 + 8);
+    for (const Scan& s: scans()) {
+        const Kernel kernels[] = {s.scalar, s.sse2, s.avx2};
+        for (int c = 0; c < 256; ++c) {
+            bool stop = s.stop((unsigned char)c);
+            for (size_t off: offsets) {
+                for (size_t n: lengths) {
+                    const char* begin = buf.data() + off;
+                    for (size_t pos = 0; pos <= n; ++pos) {
+                        // A filler none of the scans stops at, and the byte
+                        // right past the end is one all of them stop at.
+                        std::fill(buf.begin(), buf.end(), 'a');
+                        buf[off + n] = '"';
+                        if (pos < n)
+                            buf[off + pos] = (char)c;
+                        size_t want = pos < n && stop ? pos : n;
+                        for (Kernel k: kernels)
+                            if (k != nullptr && !CHECK(size_t(k(begin, begin + n) - begin) == want))
+                                fprintf(stderr, "  %s scan, byte 0x%02X at %zu of %zu\n", s.name, c, pos, n);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// A character of each class, with how it is written without and with
+// outputEscapeUnicode(), and what reads back from the latter.
+struct Escape {
+    const char* text;
+    const char* plain;
+    const char* unicode;
+    const char* read;
+};
+
+const Escape escapes[] = {
+    {"\"", "\\\"", "\\\"", "\""},
+    {"\\", "\\\\", "\\\\", "\\"},
+    {"\t", "\\t", "\\t", "\t"},
+    {"\n", "\\n", "\\n", "\n"},
+    {"\r", "\\r", "\\r", "\r"},
+    // UTF-8 of 1 to 4 bytes, those of 4 are left out when escaping.
+    {"A", "A", "A", "A"},
+    {"\xC3\xA9", "\xC3\xA9", "\\u00E9", "\xC3\xA9"},
+    {"\xE4\xB8\xAD", "\xE4\xB8\xAD", "\\u4E2D", "\xE4\xB8\xAD"},
+    {"\xF0\x9F\x98\x80", "\xF0\x9F\x98\x80", "", ""},
+};
+
+// Every escape after 0 to 70 clean bytes, so that it starts, ends or
+// straddles the end of a 16 or 32 byte block, written by the Writer (with
+// the kernel this CPU picks) and read back by the Reader.
+void testEscapes() {
+    sol::Writer plain;
+    sol::Writer unicode;
+    unicode.outputEscapeUnicode(true);
+    sol::Reader reader;
+    for (const Escape& e: escapes) {
+        for (size_t k = 0; k <= 70; ++k) {
+            std::string head(k, 'x');
+            std::string tail(40, 'y');
+            std::string text = head + e.text + tail;
+            std::string written = plain.toString(sol::Value(text));
+            if (!CHECK(written == "\"" + head + e.plain + tail + "\""))
+                fprintf(stderr, "  %s after %zu bytes\n", written.c_str(), k);
+            if (CHECK(reader.fromString("[" + written + "]")))
+                CHECK(reader.result().array()[0].view() == text);
+            written = unicode.toString(sol::Value(text));
+            if (!CHECK(written == "\"" + head + e.unicode + tail + "\""))
+                fprintf(stderr, "  %s after %zu bytes\n", written.c_str(), k);
+            if (CHECK(reader.fromString("[" + written + "]")))
+                CHECK(reader.result().array()[0].view() == head + e.read + tail);
+        }
+    }
+    // A character cut by the end of the string ends it.
+    CHECK(unicode.toString(sol::Value(sol::String(20, 'x') + "\xE4\xB8")) == "\"" + std::string(20, 'x') + "\"");
+}
+
+}
+
+int main() {
+    testScans();
+    testEscapes();
+    return sol::test::result();
+}
\ No newline at end of file
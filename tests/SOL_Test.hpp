@@ -0,0 +1,77 @@
+#ifndef SOL_TEST_HPP_INCLUDED
+#define SOL_TEST_HPP_INCLUDED
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+
+// Checks for the test programs: a failed CHECK() is reported with its 
+// line and makes the program fail, see result().
+#define CHECK(c) sol::test::check((c), #c, __FILE__, __LINE__)
+
+namespace sol {
+namespace test {
+
+inline std::atomic<int>& failures() {
+    static std::atomic<int> n{0};
+    return n;
+}
+
+inline bool check(bool ok, const char* what, const char* file, int line) {
+    if (!ok) {
+        ++failures();
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, what);
+    }
+    return ok;
+}
+
+// What main() returns.
+inline int result() {
+    if (failures() != 0)
+        fprintf(stderr, "%d checks failed\n", failures().load());
+    return failures() != 0;
+}
+
+#ifdef SOL_TEST_ALLOCATIONS
+// Calls of operator new so far, on every thread.
+inline std::atomic<size_t>& allocations() {
+    static std::atomic<size_t> n{0};
+    return n;
+}
+#endif
+
+}
+}
+
+#ifdef SOL_TEST_ALLOCATIONS
+// Every allocation of a test defining SOL_TEST_ALLOCATIONS goes through 
+// here to be counted, see allocations(). GCC takes the free() of the 
+// replaced operator delete for a mismatch.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(size_t n) {
+    sol::test::allocations().fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) {
+    return operator new(n);
+}
+void operator delete(void* p) noexcept {
+    free(p);
+}
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,141 @@
+// Readers and Writers on many threads at once, meant to be run under
+// -fsanitize=thread as well (cmake -DSOL_SANITIZE=thread). Every thread
+// parses and writes its own documents, and reads one shared value all
+// the threads hold a copy of and one plain value none of them changes.
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "../SOL.hpp"
+#include "SOL_Test.hpp"
+
+namespace {
+
+const size_t docCount = 256;
+const size_t rounds = 4;
+
+// One document of records, the i-th one always being the same.
+std::string document(size_t i) {
+    std::string s = "[";
+    for (size_t k = 0, n = 8 + i % 32; k < n; ++k) {
+        if (k)
+            s += ',';
+        s += "{id=\"" + std::to_string(i * 100 + k) + "\", name=\"n";
+        s += std::string(k % 40, char('a' + i % 26));
+        s += "\", text=\"tab\\tquote\\\"\\u00E9\\u4E2D\", tags=[\"x\",\"y\"], sub={k=\"v\"}}";
+    }
+    // Large enough for the parallel build of Reader::threads() once in a
+    // while.
+    if (i % 64 == 0)
+        for (size_t k = 0; k < 8192; ++k)
+            s += ",{k=\"" + std::string(32, 'z') + "\"}";
+    return s + "]";
+}
+
+// Const values have no operator[].
+const sol::Value& member(const sol::Value& v, const char* key) {
+    return v.object().find(key)->second;
+}
+
+// Parses and writes the documents of one thread, the text written must be
+// the one written on the main thread.
+void worker(size_t id, size_t n, const std::vector<std::string>& docs, const std::vector<std::string>& expected, const sol::Value& shared, const std::vector<std::string>& sharedText, const sol::Value& plain) {
+    sol::Reader reader;
+    sol::Writer writer;
+    // Every option touching the state of the reader, on some threads.
+    reader.recycle(id % 2 == 1);
+    reader.borrow(id % 3 == 1);
+    reader.threads(id % 4 == 2 ? 2 : 1);
+    writer.outputEscapeUnicode(id % 2 == 0);
+
+    sol::Value mine(shared);
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = id; i < docs.size(); i += n) {
+            if (!CHECK(reader.fromString(docs[i])))
+                return;
+            CHECK(writer.toString(reader.result()) == expected[i * 2 + id % 2]);
+            sol::Value v = id % 2 ? reader.shareResult() : reader.takeResult();
+            CHECK(writer.toString(v) == expected[i * 2 + id % 2]);
+        }
+        // Reads of the shared value, through the copy of this thread and
+        // through the value of the main thread.
+        const sol::Value& s = shared;
+        CHECK(member(s, "count").integer() == 42);
+        CHECK(member(s, "ratio").view() == "0.25");
+        CHECK(member(s, "borrowed").view() == "text");
+        CHECK(member(mine, "list").array().size() == 3);
+        CHECK(writer.toString(mine) == sharedText[id % 2]);
+        sol::Value copy = member(mine, "records");
+        CHECK(copy.array().size() == member(s, "records").array().size());
+        // Const reads and copies of a value which is not shared.
+        const sol::Array& a = plain.array();
+        CHECK(a[0].view() == "7" && a[0].integer() == 7);
+        CHECK(a[1].view() == "1.5" && a[1].real() == 1.5);
+        CHECK(a[2].view() == "12" && a[2].integer() == 12);
+        CHECK(a[3].view() == "a\tb");
+        sol::Value c(plain);
+        CHECK(c.array()[2].string() == "12");
+        CHECK(writer.toString(plain) == writer.toString(c));
+    }
+    CHECK(!reader.fromString("[\"unterminated"));
+    CHECK(!reader.error().empty());
+}
+
+double run(size_t n, const std::vector<std::string>& docs, const std::vector<std::string>& expected, const sol::Value& shared, const std::vector<std::string>& sharedText, const sol::Value& plain) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (size_t id = 0; id < n; ++id)
+        pool.emplace_back(worker, id, n, std::cref(docs), std::cref(expected), std::cref(shared), std::cref(sharedText), std::cref(plain));
+    for (std::thread& t: pool)
+        t.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main() {
+    std::vector<std::string> docs;
+    std::vector<std::string> expected;
+    sol::Reader reader;
+    sol::Writer writer;
+    for (size_t i = 0; i < docCount; ++i) {
+        docs.push_back(document(i));
+        CHECK(reader.fromString(docs[i]));
+        writer.outputEscapeUnicode(true);
+        expected.push_back(writer.toString(reader.result()));
+        writer.outputEscapeUnicode(false);
+        expected.push_back(writer.toString(reader.result()));
+    }
+
+    // Numbers, a borrowed string and parsed arrays in one shared value.
+    static const char borrowed[] = "text";
+    sol::Value shared;
+    shared["count"] = 42LL;
+    shared["ratio"] = 0.25;
+    shared["borrowed"] = sol::Value::borrow(borrowed, 4);
+    shared["list"] = sol::Array{sol::Value(1LL), sol::Value(true), sol::Value(sol::String("s"))};
+    CHECK(reader.fromString(docs[1]));
+    shared["records"] = reader.takeResult();
+    shared.share();
+    std::vector<std::string> sharedText;
+    writer.outputEscapeUnicode(true);
+    sharedText.push_back(writer.toString(shared));
+    writer.outputEscapeUnicode(false);
+    sharedText.push_back(writer.toString(shared));
+
+    static const char number[] = "12";
+    static const char escaped[] = "a\\tb";
+    sol::Value plain = sol::Array{sol::Value(7LL), sol::Value(1.5), sol::Value::borrow(number, 2), sol::Value::borrow(escaped, 4, true)};
+
+    size_t threads = std::max(4u, std::min(16u, std::thread::hardware_concurrency()));
+    // On many threads first, the first reads of plain are made at once.
+    double all = run(threads, docs, expected, shared, sharedText, plain);
+    double one = run(1, docs, expected, shared, sharedText, plain);
+    // The speedup only tells something on an idle machine, it is not
+    // checked.
+    printf("%zu documents x %zu: 1 thread %.3f s, %zu threads %.3f s, speedup %.2f\n", docs.size(), rounds, one, threads, all, one / all);
+    return sol::test::result();
+}
\ No newline at end of file